@@ -0,0 +1,392 @@
+/*
+    liblifx - bench.c
+    Microbenchmarks for the library's packet handling hot paths.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../lifx_internal.h"
+#include "../lifx_protocol.h"
+#include <lifx.h>
+
+#define BENCH_RUNS 5
+#define BENCH_TARGET_NS 50000000 // aim for each run to take around 50ms
+
+typedef void (*bench_func_t)(long iterations);
+
+static FILE *results = NULL;
+static uint32_t captured_source = 0;
+static volatile uint64_t sink = 0;
+static uint8_t bench_packet[LIFX_MAX_PACKET_SIZE];
+static size_t bench_packet_size = 0;
+static uint8_t **bench_macs = NULL;
+static int bench_device_count = 0;
+
+static uint64_t bench_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_send(uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port)
+{
+    lifx_header_t *header = (lifx_header_t *)packet;
+    // the library picks a random source, remember it so our fake replies get accepted
+    captured_source = header->frame.source;
+    sink += length;
+}
+
+static void bench_mac(uint8_t mac[6], int num)
+{
+    mac[0] = 0xD0;
+    mac[1] = 0x73;
+    mac[2] = 0xD5;
+    mac[3] = (num >> 16) & 0xFF;
+    mac[4] = (num >> 8) & 0xFF;
+    mac[5] = num & 0xFF;
+}
+
+static size_t bench_build_packet(uint8_t *packet, int num, uint16_t type, const void *payload, size_t size)
+{
+    lifx_header_t *header = (lifx_header_t *)packet;
+    memset(header, 0, sizeof(lifx_header_t));
+    header->frame.size = LE16(sizeof(lifx_header_t) + size);
+    header->frame.protocol = 1024;
+    header->frame.addressable = true;
+    header->frame.source = captured_source;
+    bench_mac(header->address.mac, num);
+    header->protocol.type = LE16(type);
+    memcpy(packet + sizeof(lifx_header_t), payload, size);
+    return sizeof(lifx_header_t) + size;
+}
+
+// resets the library and fills the device table with count devices
+static void bench_setup_devices(int count)
+{
+    uint8_t packet[LIFX_MAX_PACKET_SIZE];
+    uint8_t service[LIFX_STATE_SERVICE_SIZE];
+    uint8_t version[LIFX_STATE_VERSION_SIZE];
+    lifx_encode_state_service(service, &(lifx_state_service_t){ .service = 1, .port = LIFX_BROADCAST_PORT });
+    lifx_encode_state_version(version, &(lifx_state_version_t){ .vendor = 1, .product = 27 });
+    lifx_init(bench_send, NULL);
+    lifx_discover_devices();
+    for (int i = 0; i < count; i++) {
+        size_t size = bench_build_packet(packet, i, LIFX_PT_STATESERVICE, service, sizeof(service));
+        lifx_handle_incoming_packet(packet, size, 0x7F000001, LIFX_BROADCAST_PORT);
+        size = bench_build_packet(packet, i, LIFX_PT_STATEVERSION, version, sizeof(version));
+        lifx_handle_incoming_packet(packet, size, 0x7F000001, LIFX_BROADCAST_PORT);
+    }
+    bench_device_count = lifx_get_device_count();
+    free(bench_macs);
+    bench_macs = malloc(sizeof(uint8_t *) * bench_device_count);
+    for (int i = 0; i < bench_device_count; i++)
+        bench_macs[i] = lifx_get_device_mac(lifx_get_device_from_num(i));
+}
+
+static void bench_run(const char *name, bench_func_t func)
+{
+    long iterations = 1000;
+    uint64_t best = UINT64_MAX;
+    // scale the iteration count up until a run takes long enough to measure
+    while (true) {
+        uint64_t start = bench_time_ns();
+        func(iterations);
+        uint64_t elapsed = bench_time_ns() - start;
+        if (elapsed >= BENCH_TARGET_NS / 10 || iterations >= 1000000000L) {
+            iterations = elapsed > 0 ? (long)((double)iterations * BENCH_TARGET_NS / elapsed) : iterations * 10;
+            break;
+        }
+        iterations *= 10;
+    }
+    if (iterations < 1)
+        iterations = 1;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        uint64_t start = bench_time_ns();
+        func(iterations);
+        uint64_t elapsed = bench_time_ns() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+    double ns = (double)best / iterations;
+    printf("%-36s %10.2f ns/op\n", name, ns);
+    if (results != NULL)
+        fprintf(results, "%s,%.3f,%ld\n", name, ns, iterations);
+}
+
+// -- START BENCHMARKS --
+
+static void bench_handle_packet(long iterations)
+{
+    // little endian hosts don't modify the packet in place, so it can be fed repeatedly
+    for (long i = 0; i < iterations; i++)
+        lifx_handle_incoming_packet(bench_packet, bench_packet_size, 0x7F000001, LIFX_BROADCAST_PORT);
+}
+
+static void bench_send_packet(long iterations)
+{
+    lifx_device_t *device = lifx_get_device_from_num(0);
+    for (long i = 0; i < iterations; i++)
+        lifx_send_packet(device, LIFX_PT_GETCOLOR, NULL, 0);
+}
+
+static void bench_set_light_color(long iterations)
+{
+    lifx_device_t *device = lifx_get_device_from_num(0);
+    for (long i = 0; i < iterations; i++)
+        lifx_set_light_color(device, (i % 360), 0.5, 0.75, 3500, 0);
+}
+
+static void bench_get_light_color(long iterations)
+{
+    lifx_device_t *device = lifx_get_device_from_num(0);
+    double hue, saturation, brightness;
+    short kelvin;
+    for (long i = 0; i < iterations; i++) {
+        lifx_get_light_color(device, &hue, &saturation, &brightness, &kelvin);
+        sink += (uint64_t)hue;
+    }
+}
+
+static void bench_device_lookup(long iterations)
+{
+    // walk the devices with a stride so lookups land all over the table
+    int num = 0;
+    for (long i = 0; i < iterations; i++) {
+        sink += (uintptr_t)lifx_get_device(bench_macs[num]);
+        num += 7919;
+        if (num >= bench_device_count)
+            num %= bench_device_count;
+    }
+}
+
+// the old hand-written layout, read in place, to compare the generated decoder against
+typedef struct _bench_packed_light_state_t
+{
+    uint16_t hue;
+    uint16_t saturation;
+    uint16_t brightness;
+    uint16_t kelvin;
+    uint16_t reserved_1;
+    uint16_t power;
+    char label[32];
+    uint64_t reserved_2;
+} PACKED bench_packed_light_state_t;
+static_assert(sizeof(bench_packed_light_state_t) == LIFX_LIGHT_STATE_SIZE, "packed light state size");
+
+static void bench_decode_light_state(long iterations)
+{
+    lifx_light_state_t light;
+    const uint8_t *payload = bench_packet + sizeof(lifx_header_t);
+    for (long i = 0; i < iterations; i++) {
+        lifx_decode_light_state(&light, payload);
+        sink += light.color.hue + light.power + light.label[0];
+    }
+}
+
+static void bench_decode_light_state_packed(long iterations)
+{
+    const bench_packed_light_state_t *light = (const bench_packed_light_state_t *)(bench_packet + sizeof(lifx_header_t));
+    char label[32];
+    for (long i = 0; i < iterations; i++) {
+        memcpy(label, light->label, sizeof(label));
+        sink += LE16(light->hue) + LE16(light->power) + label[0];
+    }
+}
+
+static void bench_decode_state_tile_effect(long iterations)
+{
+    lifx_state_tile_effect_t effect;
+    const uint8_t *payload = bench_packet + sizeof(lifx_header_t);
+    for (long i = 0; i < iterations; i++) {
+        lifx_decode_state_tile_effect(&effect, payload);
+        sink += effect.settings.speed + effect.settings.palette[15].kelvin;
+    }
+}
+
+static void bench_encode_set_color(long iterations)
+{
+    lifx_set_color_t set_color = { .color = { 0x8000, 0xFFFF, 0x8000, 3500 }, .duration = 1000 };
+    uint8_t payload[LIFX_SET_COLOR_SIZE];
+    for (long i = 0; i < iterations; i++) {
+        set_color.color.hue = i;
+        lifx_encode_set_color(payload, &set_color);
+        sink += payload[1];
+    }
+}
+
+static void bench_message_index(long iterations)
+{
+    for (long i = 0; i < iterations; i++)
+        sink += lifx_message_index(i & 0x3FF);
+}
+
+#ifndef LIFX_NO_QUERY
+static lifx_device_t *bench_results[LIFX_MAX_DEVICE_COUNT];
+
+static void bench_query(long iterations)
+{
+    lifx_query_t query = { .require = LIFX_QUERY_COLOR | LIFX_QUERY_POWERED };
+    for (long i = 0; i < iterations; i++)
+        sink += lifx_query_devices(&query, bench_results, LIFX_MAX_DEVICE_COUNT);
+}
+
+// the same query answered with the per-device getters, as callers had to before
+static void bench_query_scan(long iterations)
+{
+    for (long i = 0; i < iterations; i++) {
+        int found = 0;
+        for (int num = 0; num < bench_device_count; num++) {
+            lifx_device_t *device = lifx_get_device_from_num(num);
+            int product = lifx_get_device_product(device);
+            if (lifx_product_is_light(product) && lifx_is_light_powered(device))
+                bench_results[found++] = device;
+        }
+        sink += found;
+    }
+}
+#endif
+
+#ifndef LIFX_NO_SNAPSHOT
+static lifx_device_record_t bench_records[LIFX_MAX_DEVICE_COUNT];
+
+static void bench_snapshot_all(long iterations)
+{
+    for (long i = 0; i < iterations; i++)
+        sink += lifx_snapshot_devices(NULL, 0, bench_records, LIFX_MAX_DEVICE_COUNT, NULL);
+}
+
+// what a client polling for changes pays when nothing has happened
+static void bench_snapshot_unchanged(long iterations)
+{
+    uint32_t generation = lifx_get_generation();
+    for (long i = 0; i < iterations; i++)
+        sink += lifx_snapshot_devices(NULL, generation, bench_records, LIFX_MAX_DEVICE_COUNT, NULL);
+}
+#endif
+
+static void bench_product_name(long iterations)
+{
+    for (long i = 0; i < iterations; i++)
+        sink += (uintptr_t)lifx_get_product_name(i & 0xFF);
+}
+
+static void bench_product_is_light(long iterations)
+{
+    for (long i = 0; i < iterations; i++)
+        sink += lifx_product_is_light(i & 0xFF);
+}
+
+// -- END BENCHMARKS --
+
+static void bench_incoming(const char *name, uint16_t type, void *payload, size_t size)
+{
+    bench_setup_devices(16);
+    bench_packet_size = bench_build_packet(bench_packet, 0, type, payload, size);
+    bench_run(name, bench_handle_packet);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        results = fopen(argv[1], "w");
+        if (results == NULL) {
+            perror(argv[1]);
+            return 1;
+        }
+        fprintf(results, "benchmark,ns_per_op,iterations\n");
+    }
+
+    uint8_t service[LIFX_STATE_SERVICE_SIZE];
+    uint8_t version[LIFX_STATE_VERSION_SIZE];
+    uint8_t firmware[LIFX_STATE_HOST_FIRMWARE_SIZE];
+    uint8_t label[LIFX_STATE_LABEL_SIZE] = "Benchmark Light";
+    uint8_t light[LIFX_LIGHT_STATE_SIZE];
+    uint8_t power[LIFX_STATE_LIGHT_POWER_SIZE];
+    uint8_t tile_effect[LIFX_STATE_TILE_EFFECT_SIZE];
+    lifx_encode_state_service(service, &(lifx_state_service_t){ .service = 1, .port = LIFX_BROADCAST_PORT });
+    lifx_encode_state_version(version, &(lifx_state_version_t){ .vendor = 1, .product = 27 });
+    lifx_encode_state_host_firmware(firmware, &(lifx_state_host_firmware_t){ .version_major = 3, .version_minor = 70 });
+    lifx_encode_light_state(light, &(lifx_light_state_t){ .color = { 0x8000, 0xFFFF, 0x8000, 3500 }, .power = 0xFFFF,
+        .label = "Benchmark Light" });
+    lifx_encode_state_light_power(power, &(lifx_state_light_power_t){ .level = 0xFFFF });
+    lifx_encode_state_tile_effect(tile_effect, &(lifx_state_tile_effect_t){ .settings = { .type = 2, .speed = 5000, .palette_count = 16 } });
+
+    bench_incoming("incoming/state_service", LIFX_PT_STATESERVICE, service, sizeof(service));
+    bench_incoming("incoming/state_version", LIFX_PT_STATEVERSION, version, sizeof(version));
+    bench_incoming("incoming/state_host_firmware", LIFX_PT_STATEHOSTFIRMWARE, firmware, sizeof(firmware));
+    bench_incoming("incoming/state_label", LIFX_PT_STATELABEL, label, sizeof(label));
+    bench_incoming("incoming/light_state", LIFX_PT_LIGHTSTATE, light, sizeof(light));
+    bench_incoming("incoming/state_light_power", LIFX_PT_STATELIGHTPOWER, power, sizeof(power));
+    // packets from another client's source are dropped straight away
+    bench_setup_devices(16);
+    bench_packet_size = bench_build_packet(bench_packet, 0, LIFX_PT_LIGHTSTATE, light, sizeof(light));
+    ((lifx_header_t *)bench_packet)->frame.source = ~captured_source;
+    bench_run("incoming/wrong_source", bench_handle_packet);
+
+    // the codec on its own, without the rest of the packet handling
+    bench_packet_size = bench_build_packet(bench_packet, 0, LIFX_PT_LIGHTSTATE, light, sizeof(light));
+    bench_run("codec/decode_light_state", bench_decode_light_state);
+    bench_run("codec/decode_light_state_packed", bench_decode_light_state_packed);
+    if (sizeof(lifx_header_t) + sizeof(tile_effect) <= sizeof(bench_packet)) {
+        bench_packet_size = bench_build_packet(bench_packet, 0, LIFX_PT_STATETILEEFFECT, tile_effect, sizeof(tile_effect));
+        bench_run("codec/decode_state_tile_effect", bench_decode_state_tile_effect);
+    }
+    bench_run("codec/encode_set_color", bench_encode_set_color);
+    bench_run("codec/message_index", bench_message_index);
+
+    bench_setup_devices(16);
+    bench_run("outgoing/send_packet", bench_send_packet);
+    bench_run("outgoing/set_light_color", bench_set_light_color);
+    bench_run("color/get_light_color", bench_get_light_color);
+
+    static const int lookup_sizes[] = { 16, 1024, 10240 };
+    for (int i = 0; i < sizeof(lookup_sizes) / sizeof(lookup_sizes[0]); i++) {
+        char name[64];
+        bench_setup_devices(lookup_sizes[i]);
+        if (bench_device_count < lookup_sizes[i]) {
+            printf("skipping lookup at %i devices, table only holds %i\n", lookup_sizes[i], bench_device_count);
+            continue;
+        }
+        snprintf(name, sizeof(name), "lookup/device_%i", lookup_sizes[i]);
+        bench_run(name, bench_device_lookup);
+    }
+
+#ifndef LIFX_NO_QUERY
+    // every other light is on
+    static const int query_sizes[] = { 16, 1024 };
+    for (int i = 0; i < sizeof(query_sizes) / sizeof(query_sizes[0]); i++) {
+        char name[64];
+        bench_setup_devices(query_sizes[i]);
+        if (bench_device_count < query_sizes[i]) {
+            printf("skipping query at %i devices, table only holds %i\n", query_sizes[i], bench_device_count);
+            continue;
+        }
+        for (int num = 0; num < bench_device_count; num += 2) {
+            size_t size = bench_build_packet(bench_packet, num, LIFX_PT_LIGHTSTATE, light, sizeof(light));
+            lifx_handle_incoming_packet(bench_packet, size, 0x7F000001, LIFX_BROADCAST_PORT);
+        }
+        snprintf(name, sizeof(name), "query/powered_color_%i", query_sizes[i]);
+        bench_run(name, bench_query);
+        snprintf(name, sizeof(name), "query/powered_color_scan_%i", query_sizes[i]);
+        bench_run(name, bench_query_scan);
+#ifndef LIFX_NO_SNAPSHOT
+        snprintf(name, sizeof(name), "snapshot/all_%i", query_sizes[i]);
+        bench_run(name, bench_snapshot_all);
+        snprintf(name, sizeof(name), "snapshot/unchanged_%i", query_sizes[i]);
+        bench_run(name, bench_snapshot_unchanged);
+#endif
+    }
+#endif
+
+    bench_run("product/get_product_name", bench_product_name);
+    bench_run("product/product_is_light", bench_product_is_light);
+
+    if (results != NULL)
+        fclose(results);
+    free(bench_macs);
+    return 0;
+}
@@ -9,22 +9,410 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <lifx_config.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 #ifndef LIFX_INTERNAL_H_
 typedef uint8_t lifx_device_t;
+#else
+typedef struct _lifx_device_t lifx_device_t;
 #endif
 
-#define LIFX_MAX_PACKET_SIZE 0x80
+typedef struct _lifx_hsbk_t
+{
+    uint16_t hue; // 0-65535 maps to 0-360 degrees
+    uint16_t saturation;
+    uint16_t brightness;
+    uint16_t kelvin;
+} lifx_hsbk_t;
+
+#define LIFX_MULTIZONE_EFFECT_OFF 0
+#define LIFX_MULTIZONE_EFFECT_MOVE 1
+
+#define LIFX_TILE_EFFECT_OFF 0
+#define LIFX_TILE_EFFECT_MORPH 2
+#define LIFX_TILE_EFFECT_FLAME 3
+#define LIFX_TILE_EFFECT_SKY 5
+
+// sky effect types, set in parameters[0] of a LIFX_TILE_EFFECT_SKY effect
+#define LIFX_SKY_SUNRISE 0
+#define LIFX_SKY_SUNSET 1
+#define LIFX_SKY_CLOUDS 2
+
+#define LIFX_EFFECT_MAX_PALETTE 16
+
+typedef struct _lifx_effect_t
+{
+    uint8_t type; // LIFX_MULTIZONE_EFFECT_* or LIFX_TILE_EFFECT_*
+    uint32_t instance_id; // set by the device, ignored when setting an effect
+    uint32_t speed_ms; // time for one cycle of the effect
+    uint64_t duration_ns; // how long the effect runs for, 0 runs forever
+    uint32_t parameters[8]; // effect specific, e.g. move direction in parameters[1] or sky type and cloud saturation in parameters[0-2]
+    uint8_t palette_count; // tile effects only
+    lifx_hsbk_t palette[LIFX_EFFECT_MAX_PALETTE];
+} lifx_effect_t;
+
+typedef enum _lifx_drop_reason_t
+{
+    LIFX_DROP_SIZE, // packet was shorter than a header or didn't match the size in it
+    LIFX_DROP_PAYLOAD_SIZE, // payload was the wrong size for its message type
+    LIFX_DROP_SOURCE, // packet was a reply to another client
+    LIFX_DROP_UNKNOWN_DEVICE, // packet came from a device that hasn't been discovered
+    LIFX_DROP_SERVICE, // device advertised a service other than UDP
+    LIFX_DROP_TABLE_FULL, // new device was found but there's no space left for it
+    LIFX_DROP_UNHANDLED, // message type isn't handled by the library
+    LIFX_DROP_REASON_COUNT
+} lifx_drop_reason_t;
+
+typedef struct _lifx_stats_t
+{
+    uint64_t packets_in;
+    uint64_t bytes_in;
+    uint64_t packets_out;
+    uint64_t bytes_out;
+    uint64_t drops[LIFX_DROP_REASON_COUNT];
+    uint64_t table_full; // times a device couldn't be added to a full device table
+    uint64_t sends_offline; // packets sent to devices that haven't been heard from recently
+    // per message type counters, these wrap around so take the difference between snapshots
+    uint32_t type_packets_in[LIFX_STATS_TYPE_COUNT];
+    uint32_t type_bytes_in[LIFX_STATS_TYPE_COUNT];
+    uint32_t type_packets_out[LIFX_STATS_TYPE_COUNT];
+    uint32_t type_bytes_out[LIFX_STATS_TYPE_COUNT];
+} lifx_stats_t;
+
+typedef enum _lifx_waveform_t
+{
+    LIFX_WAVEFORM_SAW = 0,
+    LIFX_WAVEFORM_SINE = 1,
+    LIFX_WAVEFORM_HALF_SINE = 2,
+    LIFX_WAVEFORM_TRIANGLE = 3,
+    LIFX_WAVEFORM_PULSE = 4,
+} lifx_waveform_t;
+
+// Which parts of the colour a waveform changes, the rest are left as they are.
+#define LIFX_WAVEFORM_SET_HUE        (1 << 0)
+#define LIFX_WAVEFORM_SET_SATURATION (1 << 1)
+#define LIFX_WAVEFORM_SET_BRIGHTNESS (1 << 2)
+#define LIFX_WAVEFORM_SET_KELVIN     (1 << 3)
+#define LIFX_WAVEFORM_SET_ALL        0x0F
 
 typedef void (*lifx_send_packet_t)(uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port);
-typedef void (*lifx_device_update_t)(lifx_device_t *device, bool new);
+// Non-blocking version of lifx_send_packet_t, returns -1 if the packet can't be sent right now (e.g. EAGAIN) and 0 otherwise.
+typedef int (*lifx_try_send_packet_t)(uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port);
+// Version of lifx_try_send_packet_t that's also told which interface (from lifx_add_interface) the packet should leave
+// by, or -1 if it isn't tied to one. Returns -1 if the packet can't be sent right now and 0 otherwise.
+typedef int (*lifx_send_interface_packet_t)(uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port, int interface);
+typedef void (*lifx_device_update_t)(lifx_device_t *device, bool is_new);
+typedef uint64_t (*lifx_clock_t)(void);
+
+#ifndef LIFX_NO_SCHEDULE
+typedef enum _lifx_command_type_t
+{
+    LIFX_COMMAND_COLOR, // fade a light to a colour
+    LIFX_COMMAND_POWER, // power a light on or off
+} lifx_command_type_t;
+
+typedef struct _lifx_command_t
+{
+    lifx_device_t *device;
+    lifx_command_type_t type;
+    lifx_hsbk_t color; // LIFX_COMMAND_COLOR
+    bool powered; // LIFX_COMMAND_POWER
+    uint32_t duration_ms; // length of the transition
+} lifx_command_t;
+#endif
+
+#ifndef LIFX_NO_SCENES
+// One light's part of a scene, a scene is an array of these.
+typedef struct _lifx_scene_entry_t
+{
+    lifx_device_t *device;
+    lifx_hsbk_t color;
+    bool powered;
+    uint32_t duration_ms; // length of the transition into the scene
+} lifx_scene_entry_t;
+
+typedef enum _lifx_scene_result_t
+{
+    LIFX_SCENE_UNCHANGED, // the light was already in the scene, nothing was sent
+    LIFX_SCENE_CONFIRMED, // the light replied to everything sent to it
+    LIFX_SCENE_TIMEOUT, // something sent to the light wasn't answered in time
+    LIFX_SCENE_REPLACED, // another scene was applied to the light before it answered
+} lifx_scene_result_t;
+
+typedef void (*lifx_scene_callback_t)(lifx_device_t *device, lifx_scene_result_t result, void *context);
+#endif
+
+#ifndef LIFX_NO_RECONCILE
+// Which parts of a target are set, the rest are left however they are.
+#define LIFX_TARGET_COLOR (1 << 0)
+#define LIFX_TARGET_POWER (1 << 1)
+
+// State a light should be kept in, see lifx_set_target.
+typedef struct _lifx_target_t
+{
+    uint8_t fields; // LIFX_TARGET_* bits
+    lifx_hsbk_t color;
+    bool powered;
+    uint32_t duration_ms; // length of the transition each time the target is sent
+} lifx_target_t;
+
+typedef enum _lifx_convergence_t
+{
+    LIFX_CONVERGENCE_NONE, // no target is set
+    LIFX_CONVERGENCE_SENDING, // the light reported something else, the target is waiting to be sent
+    LIFX_CONVERGENCE_VERIFYING, // the target was sent (or looked to be there already), waiting for the light to report
+    LIFX_CONVERGENCE_CONVERGED, // the light last reported the target state
+    LIFX_CONVERGENCE_UNREACHABLE, // the light didn't answer, backing off before trying again
+} lifx_convergence_t;
+
+typedef struct _lifx_convergence_info_t
+{
+    lifx_convergence_t status;
+    uint8_t attempts; // times the target has been sent since the light last converged
+    int32_t next_ms; // milliseconds until the light is next sent to or checked, -1 if it has no target
+} lifx_convergence_info_t;
+#endif
+
+#ifndef LIFX_NO_REQUESTS
+typedef enum _lifx_request_type_t
+{
+    LIFX_REQUEST_LIGHT_STATE, // colour, power and label of a light
+    LIFX_REQUEST_LIGHT_POWER, // power level of a light
+    LIFX_REQUEST_LABEL, // label of any device
+    LIFX_REQUEST_VERSION, // vendor and product of any device
+    LIFX_REQUEST_HOST_FIRMWARE, // firmware version of any device
+    LIFX_REQUEST_WIFI_INFO, // Wi-Fi signal strength of any device
+    LIFX_REQUEST_TYPE_COUNT
+} lifx_request_type_t;
+
+typedef enum _lifx_request_status_t
+{
+    LIFX_REQUEST_COMPLETE, // the device replied
+    LIFX_REQUEST_TIMEOUT, // no reply arrived in time, the response is NULL
+} lifx_request_status_t;
+
+// Decoded reply to a request, only the fields for the request's type are set.
+typedef struct _lifx_response_t
+{
+    lifx_request_type_t type;
+    lifx_hsbk_t light; // LIFX_REQUEST_LIGHT_STATE
+    uint16_t power; // LIFX_REQUEST_LIGHT_STATE and LIFX_REQUEST_LIGHT_POWER
+    char label[33]; // LIFX_REQUEST_LIGHT_STATE and LIFX_REQUEST_LABEL, always terminated
+    uint32_t vendor; // LIFX_REQUEST_VERSION
+    uint32_t product; // LIFX_REQUEST_VERSION
+    uint64_t firmware_build; // LIFX_REQUEST_HOST_FIRMWARE
+    uint16_t firmware_major; // LIFX_REQUEST_HOST_FIRMWARE
+    uint16_t firmware_minor; // LIFX_REQUEST_HOST_FIRMWARE
+    float signal; // LIFX_REQUEST_WIFI_INFO, in mW
+} lifx_response_t;
+
+// Handle to a request, -1 when a request couldn't be made.
+typedef int32_t lifx_request_t;
+typedef void (*lifx_request_callback_t)(lifx_request_t request, lifx_device_t *device, lifx_request_status_t status,
+    const lifx_response_t *response, void *context);
+#endif
+
+// Classes of outgoing packet. When the transport can't keep up, packets wait in a queue per class
+// and a class is only sent once every class before it is empty.
+typedef enum _lifx_priority_t
+{
+    LIFX_PRIORITY_INTERACTIVE, // commands and requests made by the caller
+    LIFX_PRIORITY_RETRY, // colours resent because the device didn't confirm them
+    LIFX_PRIORITY_BACKGROUND, // discovery and polling
+    LIFX_PRIORITY_COUNT
+} lifx_priority_t;
+
+#ifndef LIFX_NO_SEND_QUEUE
+typedef struct _lifx_queue_stats_t
+{
+    uint16_t depth[LIFX_PRIORITY_COUNT]; // packets waiting now
+    uint16_t peak[LIFX_PRIORITY_COUNT]; // most packets that have waited at once
+    uint32_t queued[LIFX_PRIORITY_COUNT]; // packets that had to wait
+    uint32_t dropped[LIFX_PRIORITY_COUNT]; // oldest packets pushed out of a full queue
+    bool blocked; // the transport has said it can't take any more
+} lifx_queue_stats_t;
+#endif
+
+#ifndef LIFX_NO_INTERFACES
+// A local IPv4 network interface, all addresses are in host order.
+typedef struct _lifx_interface_t
+{
+    uint32_t ipv4; // this end's address on the interface
+    uint32_t netmask;
+    uint32_t broadcast; // directed broadcast address of the subnet, where discovery is sent
+} lifx_interface_t;
+#endif
+
+#ifndef LIFX_NO_QUERY
+// Properties devices can be queried by.
+#define LIFX_QUERY_LIGHT     (1 << 0) // any light
+#define LIFX_QUERY_COLOR     (1 << 1) // can show colours, not just whites
+#define LIFX_QUERY_MULTIZONE (1 << 2)
+#define LIFX_QUERY_MATRIX    (1 << 3)
+#define LIFX_QUERY_HEV       (1 << 4)
+#define LIFX_QUERY_POWERED   (1 << 5) // light last reported being on
+#define LIFX_QUERY_ONLINE    (1 << 6) // heard from in the last 30 seconds
+#define LIFX_QUERY_PROPERTY_COUNT 7
+
+typedef struct _lifx_query_t
+{
+    uint8_t require; // LIFX_QUERY_* bits a device must have
+    uint8_t exclude; // LIFX_QUERY_* bits a device mustn't have
+    const uint8_t *group; // 16 byte ID of the group a device must be in, NULL for any
+    const uint8_t *location; // 16 byte ID of the location a device must be in, NULL for any
+} lifx_query_t;
+#endif
+
+#ifndef LIFX_NO_SNAPSHOT
+// Copy of a device's state from lifx_snapshot_devices, addresses are in host order.
+typedef struct _lifx_device_record_t
+{
+    lifx_device_t *device;
+    uint32_t generation; // generation the device last changed in
+    uint8_t mac[6];
+    uint16_t port;
+    uint32_t ipv4;
+    uint32_t product;
+    int32_t latency; // as lifx_get_device_latency
+    uint32_t last_seen_ms; // milliseconds since the device was last heard from, this alone isn't counted as a change
+    uint8_t properties; // LIFX_QUERY_* bits
+    bool transition; // the colour is a prediction part way through a transition
+    uint16_t power;
+    lifx_hsbk_t color; // as lifx_get_light_hsbk
+    uint16_t firmware_major;
+    uint16_t firmware_minor;
+    uint8_t group[16]; // group and location IDs, all zeroes until the device has said
+    uint8_t location[16];
+    char label[33]; // always terminated
+} lifx_device_record_t;
+#endif
+
+#ifndef LIFX_NO_SHM
+// A device table mapped from shared memory, see lifx_shm_open.
+typedef struct _lifx_shm_t lifx_shm_t;
+#endif
+
+#ifndef LIFX_NO_LINK
+typedef enum _lifx_link_quality_t
+{
+    LIFX_LINK_GOOD, // strong signal and everything answered, or nothing measured yet
+    LIFX_LINK_FAIR,
+    LIFX_LINK_POOR,
+    LIFX_LINK_BAD, // barely connected, most packets go missing
+} lifx_link_quality_t;
+
+// A device's Wi-Fi link and the send budget the library gives it.
+typedef struct _lifx_link_info_t
+{
+    lifx_link_quality_t quality; // the worst of the signal, loss and round trip
+    float signal; // Wi-Fi signal in mW as reported by the device, 0 if it hasn't said yet
+    uint8_t loss_percent; // share of recent tracked packets that weren't answered
+    uint16_t rtt_ms; // smoothed round trip time, 0 if not measured yet
+    uint16_t frame_interval_ms; // minimum time between frames sent by lifx_stream_light_hsbk
+    uint8_t retries; // times an unconfirmed colour is resent
+} lifx_link_info_t;
+#endif
 
 // Initialises the library, provided a function to send packets and optionally a function to call when device state is updated.
 void lifx_init(lifx_send_packet_t send_packet, lifx_device_update_t device_update);
 
+// Sets the function the library reads the time from, in milliseconds. It only has to be monotonic, not wall clock time.
+// The default is CLOCK_MONOTONIC_COARSE (or lifx_platform_time_ms with LIFX_NO_SYSTEM_TIME), NULL restores it.
+void lifx_set_clock(lifx_clock_t clock);
+
+// Sets the source value sent with packets, replies for any other source are ignored. lifx_init picks a random one.
+void lifx_set_source(uint32_t source);
+// Gets the source value sent with packets.
+uint32_t lifx_get_source();
+
 // Function to be called when a new packet is recieved by the caller.
 void lifx_handle_incoming_packet(uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port);
 
+// Function to be called regularly by the caller (every 10-100ms), runs anything that's waiting on time passing.
+void lifx_tick();
+// Gets the milliseconds until lifx_tick next has something to do (0 if it's overdue), or -1 if nothing is waiting.
+// Callers can sleep for this long instead of ticking at a fixed rate, which also makes scheduled commands more precise.
+int32_t lifx_get_next_deadline();
+
+#ifndef LIFX_NO_SEND_QUEUE
+// Sends packets with a transport that can refuse them instead of blocking, replacing the one given to lifx_init until
+// the next lifx_init (NULL goes back to it.) Refused packets wait in a bounded queue per lifx_priority_t, up to
+// LIFX_SEND_QUEUE_SIZE each, and go out from lifx_transport_writable or lifx_tick.
+void lifx_set_try_send(lifx_try_send_packet_t try_send);
+// Function to be called when the transport can take packets again (e.g. the socket polls writable.)
+void lifx_transport_writable();
+// Copies a snapshot of the send queue's depth and counters.
+void lifx_get_queue_stats(lifx_queue_stats_t *stats);
+#endif
+
+// Copies a snapshot of the library's traffic and drop counters.
+void lifx_get_stats(lifx_stats_t *stats);
+// Resets all of the library's traffic and drop counters to zero.
+void lifx_reset_stats();
+
+#ifndef LIFX_NO_STDIO
+// Starts capturing all sent and received packets to a pcap file, written from a background thread.
+// The local IPv4 (in host order) and port are used as this end's address in the synthesized headers.
+int lifx_capture_start(const char *path, uint32_t local_ipv4, uint16_t local_port);
+// Stops capturing packets, writing out any that are still waiting and closing the file. Safe to call from any
+// thread, it waits for a packet being captured on another one to finish.
+void lifx_capture_stop();
+// Gets the number of packets written to the capture file, dropped because the capture buffer was full, and
+// lost because writing to the file failed.
+void lifx_capture_get_counts(uint64_t *written, uint64_t *dropped, uint64_t *failed);
+#endif
+
+#ifndef LIFX_NO_SCHEDULE
+// Runs a set of commands so they take effect together delay_ms from now. Each one is sent early by half of its
+// device's measured round trip latency, so delay_ms should be longer than that for the slowest device. Commands
+// are sent from lifx_tick, returns the number scheduled or -1 if they can't all be.
+int lifx_apply_synchronized(const lifx_command_t *commands, int count, uint32_t delay_ms);
+// Gets the number of commands waiting to be sent.
+int lifx_get_scheduled_count();
+#endif
+
+#ifndef LIFX_NO_SCENES
+// Saves the colour and power of each light in devices to an entry of scene, with a transition of duration_ms.
+// A light part way through a transition is saved with the colour it's heading to. Returns count, or -1 if any
+// of them isn't a known light.
+int lifx_save_scene(lifx_device_t **devices, int count, uint32_t duration_ms, lifx_scene_entry_t *scene);
+// Applies a scene delay_ms from now, as lifx_apply_synchronized, only sending the colours and power levels that
+// differ from each light's cached state. callback (if not NULL) is called once for every light in the scene, from
+// lifx_handle_incoming_packet or lifx_tick when it confirms or times out, and before this returns for lights that
+// needed nothing. Commands still scheduled for the scene's lights, from an earlier scene or lifx_apply_synchronized,
+// are dropped. Returns the number of lights that were sent something, or -1 if the scene can't all be scheduled.
+int lifx_apply_scene(const lifx_scene_entry_t *scene, int count, uint32_t delay_ms, lifx_scene_callback_t callback, void *context);
+// Gets the number of lights yet to confirm a scene.
+int lifx_get_pending_scene_count();
+#endif
+
+#ifndef LIFX_NO_RECONCILE
+// Sets the state a light should be kept in, or with NULL stops managing it. From lifx_tick the library sends the target
+// to lights whose reported state differs, checks each one with a poll once its transition is done, and polls converged
+// lights every LIFX_RECONCILE_CHECK_MS so ones that reboot or were changed by something else are put back. At most
+// LIFX_RECONCILE_RATE packets a second are sent for all the lights together, and lights that don't answer or keep
+// diverging are backed off for up to LIFX_RECONCILE_MAX_BACKOFF_MS. Returns -1 if the device isn't a known light.
+int lifx_set_target(lifx_device_t *device, const lifx_target_t *target);
+// Gets how a light is doing at reaching its target, returns -1 if the device isn't known.
+int lifx_get_convergence(lifx_device_t *device, lifx_convergence_info_t *info);
+// Gets the number of lights with a target that haven't converged on it.
+int lifx_get_diverged_count();
+#endif
+
+#ifndef LIFX_NO_REQUESTS
+// Asks a device for some of its state, calling the callback with the reply or once timeout_ms has passed (0 for the
+// default.) The device's cached state is updated before the callback is called. Timeouts are checked by lifx_tick.
+lifx_request_t lifx_request(lifx_device_t *device, lifx_request_type_t type, uint32_t timeout_ms, lifx_request_callback_t callback, void *context);
+// Forgets about a request without calling its callback, returns -1 if it's already finished.
+int lifx_cancel_request(lifx_request_t request);
+// Gets the number of requests waiting for a reply.
+int lifx_get_pending_request_count();
+#endif
+
 // Gets the number of LIFX devices the library has seen.
 int lifx_get_device_count();
 // Gets a handle to a LIFX device from an index, starting from 0.
@@ -32,12 +420,31 @@ lifx_device_t *lifx_get_device_from_num(int num);
 // Gets a handle to a LIFX device from a device's MAC address.
 lifx_device_t *lifx_get_device(uint8_t mac[6]);
 
-// Broadcasts a device discovery packet.
+// Broadcasts a device discovery packet, to every interface's subnet if any have been added.
 void lifx_discover_devices();
 // Fires a device discovery packet towards a given IP (in host order).
 void lifx_discover_device(uint32_t ipv4);
 
-// Gets the latency from the computer to the device (at the time of discovery.)
+#ifndef LIFX_NO_INTERFACES
+// Adds a local interface (addresses in host order) for discovery to broadcast on, returning its index or -1 if the
+// table is full or it has no subnet to broadcast to. Interfaces are forgotten by lifx_init.
+int lifx_add_interface(uint32_t ipv4, uint32_t netmask);
+#ifndef LIFX_NO_IFADDRS
+// Adds every interface that's up and can broadcast, returning the number added or -1 if they couldn't be listed.
+int lifx_scan_interfaces();
+#endif
+// Gets the number of interfaces that have been added.
+int lifx_get_interface_count();
+// Copies an interface's addresses, returns -1 if there isn't one at that index.
+int lifx_get_interface(int index, lifx_interface_t *interface);
+// Gets the index of the interface a device was found on (the one whose subnet it's in), or -1 if none match.
+int lifx_get_device_interface(lifx_device_t *device);
+// Sends packets with a transport that picks the interface for each one, replacing the one given to lifx_init and
+// lifx_set_try_send until the next lifx_init (NULL goes back to them.)
+void lifx_set_interface_send(lifx_send_interface_packet_t send);
+#endif
+
+// Gets the latency from the computer to the device, measured when it first answered a discovery (-1 if it hasn't.)
 int lifx_get_device_latency(lifx_device_t *device);
 // Gets the product type of a device.
 int lifx_get_device_product(lifx_device_t *device);
@@ -47,23 +454,116 @@ uint8_t *lifx_get_device_mac(lifx_device_t *device);
 uint32_t lifx_get_device_ipv4(lifx_device_t *device);
 // Gets the current label of a device.
 char *lifx_get_device_label(lifx_device_t *device);
+// Gets the label of the group a device is in and copies its 16 byte ID to uuid (if not NULL.)
+// The label is empty and the ID all zeroes until the device has said.
+char *lifx_get_device_group(lifx_device_t *device, uint8_t uuid[16]);
+// Gets the label of the location a device is in and copies its 16 byte ID to uuid (if not NULL.)
+char *lifx_get_device_location(lifx_device_t *device, uint8_t uuid[16]);
 // Gets the major firmware version of a device.
 int lifx_get_device_firmware_major(lifx_device_t *device);
 // Gets the minor firmware revision of a device.
 int lifx_get_device_firmware_minor(lifx_device_t *device);
 
-// Gets the current light colour from a light device.
+#ifndef LIFX_NO_QUERY
+// Finds the devices matching a query, writing up to max_results handles (in table order) to results, which can be
+// NULL to only count them. Returns the number of matches, which can be more than max_results. The properties are
+// kept up to date as packets arrive, so this doesn't look at each device.
+int lifx_query_devices(const lifx_query_t *query, lifx_device_t **results, int max_results);
+#endif
+
+#ifndef LIFX_NO_SNAPSHOT
+// Copies the state of every device matching query (NULL for all) that has changed since generation since (0 for all)
+// into records, up to max_records, in table order. Lights part way through a transition are always included.
+// Returns the number of devices that matched, which can be more than max_records, and sets generation (if not NULL)
+// to the generation to pass as since next time. Devices that have stopped matching the query aren't reported.
+int lifx_snapshot_devices(const lifx_query_t *query, uint32_t since, lifx_device_record_t *records, int max_records,
+    uint32_t *generation);
+// Gets the current generation, which goes up every time any device's state changes.
+uint32_t lifx_get_generation();
+#endif
+
+#ifndef LIFX_NO_SHM
+// Publishes the device table to a POSIX shared memory object called name (e.g. "/lifx"), replacing anything already
+// there, so other processes on the host can read it with lifx_shm_open instead of running their own discovery.
+// The table is brought up to date from lifx_tick whenever a device changes, and at least every LIFX_SHM_INTERVAL_MS.
+// Returns -1 if the object couldn't be created.
+int lifx_shm_publish(const char *name);
+// Stops publishing and removes the shared memory object, readers that have it open see it as closed.
+void lifx_shm_unpublish();
+// Maps a device table published by another process, read-only. Returns NULL if there isn't one, or it was published
+// by a build with a different table layout. Reading it makes no system calls.
+lifx_shm_t *lifx_shm_open(const char *name);
+void lifx_shm_close(lifx_shm_t *shm);
+// Gets the generation the publisher had reached when it last brought the table up to date, 0 once it's closed.
+uint32_t lifx_shm_get_generation(lifx_shm_t *shm);
+// Copies devices from the table as lifx_snapshot_devices does, the device handles in the records are always NULL.
+// Returns -1 once the publisher has unpublished the table, published it again or called lifx_init again, close it
+// and open it again, then read it with a since of 0.
+int lifx_shm_read_devices(lifx_shm_t *shm, uint32_t since, lifx_device_record_t *records, int max_records, uint32_t *generation);
+#endif
+
+#ifndef LIFX_FIXED_POINT
+// Gets the current light colour from a light device. While a transition started by this library is
+// running, this is a prediction of where the transition has got to.
 int lifx_get_light_color(lifx_device_t *device, double *hue, double *saturation, double *brightness, short *kelvin);
-// Gets whether a light device is powered on or not.
-bool lifx_is_light_powered(lifx_device_t *device);
 // Sets the colour of a light device, over a period of time ms.
 void lifx_set_light_color(lifx_device_t *device, double hue, double saturation, double brightness, short kelvin, uint32_t time);
+#endif
+// Gets the current light colour from a light device, as raw values (hue 0-65535 maps to 0-360 degrees).
+int lifx_get_light_hsbk(lifx_device_t *device, uint16_t *hue, uint16_t *saturation, uint16_t *brightness, uint16_t *kelvin);
+// Sets the colour of a light device from raw values, over a period of time ms.
+void lifx_set_light_hsbk(lifx_device_t *device, uint16_t hue, uint16_t saturation, uint16_t brightness, uint16_t kelvin, uint32_t time);
+// Gets the power level of a light device (0 is off, 65535 is on.)
+int lifx_get_light_power(lifx_device_t *device, uint16_t *power);
+// Gets whether a light device is powered on or not.
+bool lifx_is_light_powered(lifx_device_t *device);
+#ifndef LIFX_FIXED_POINT
+// Runs a waveform effect on a light device, moving towards the given colour and back for a number of cycles each lasting period_ms.
+// Transient effects return to the original colour afterwards. skew_ratio (0-1) sets how much of a cycle is spent on the new colour,
+// and set_mask (LIFX_WAVEFORM_SET_*) picks which parts of the colour are affected.
+void lifx_set_light_waveform(lifx_device_t *device, lifx_waveform_t waveform, bool transient, double hue, double saturation, double brightness,
+    short kelvin, uint32_t period_ms, float cycles, double skew_ratio, uint8_t set_mask);
+#endif
+// Runs a waveform effect on a light device, using raw colour values and a raw skew ratio (-32768 to 32767).
+void lifx_set_light_waveform_hsbk(lifx_device_t *device, lifx_waveform_t waveform, bool transient, uint16_t hue, uint16_t saturation,
+    uint16_t brightness, uint16_t kelvin, uint32_t period_ms, float cycles, int16_t skew_ratio, uint8_t set_mask);
 // Powers a light device on or off, over a period of time ms.
 void lifx_set_light_powered(lifx_device_t *device, bool powered, uint32_t time);
 
+#ifndef LIFX_NO_LINK
+// Sets a light's colour as one frame of an animation. Frames are sent no faster than the device's link allows,
+// anything arriving sooner replaces the frame waiting to go out, which is sent by lifx_tick.
+void lifx_stream_light_hsbk(lifx_device_t *device, uint16_t hue, uint16_t saturation, uint16_t brightness, uint16_t kelvin, uint32_t time);
+// Gets the Wi-Fi link quality of a device and its send budget, returns -1 if the device isn't known.
+// The signal is polled every LIFX_LINK_POLL_MS, loss and round trip come from polls and colours being confirmed.
+int lifx_get_device_link(lifx_device_t *device, lifx_link_info_t *info);
+#endif
+
+#ifndef LIFX_NO_STDIO
+// Saves the known devices to a cache file, returning the number saved or -1 on failure.
+int lifx_save_device_cache(const char *path);
+// Loads devices from a cache file so they can be used before discovery, returning the number loaded or -1 on failure.
+int lifx_load_device_cache(const char *path);
+#endif
+
+#ifndef LIFX_NO_EFFECTS
+// Starts (or with LIFX_MULTIZONE_EFFECT_OFF, stops) a firmware effect on a multizone device.
+void lifx_set_multizone_effect(lifx_device_t *device, const lifx_effect_t *effect);
+// Starts (or with LIFX_TILE_EFFECT_OFF, stops) a firmware effect on a matrix device, including its palette.
+void lifx_set_tile_effect(lifx_device_t *device, const lifx_effect_t *effect);
+// Asks a multizone or matrix device for the effect it's running.
+void lifx_request_effect(lifx_device_t *device);
+// Gets the last effect a device reported it was running, returns -1 if it hasn't reported one.
+int lifx_get_device_effect(lifx_device_t *device, lifx_effect_t *effect);
+#endif
+
 // Gets the name of a product type given its ID.
 char *lifx_get_product_name(int product_id);
 // Gets whether a given product ID is a light.
 bool lifx_product_is_light(int product_id);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // LIFX_H_
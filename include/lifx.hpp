@@ -0,0 +1,207 @@
+/*
+    liblifx - lifx.hpp
+    Header-only C++20 wrapper for the liblifx library, with awaitable requests.
+*/
+
+#ifndef LIFX_HPP_
+#define LIFX_HPP_
+
+#include <array>
+#include <coroutine>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <optional>
+#include <string_view>
+#include <lifx.h>
+
+#ifdef LIFX_NO_REQUESTS
+#error "lifx.hpp needs the request API, build without LIFX_NO_REQUESTS"
+#endif
+
+namespace lifx {
+
+using hsbk = lifx_hsbk_t;
+using label = std::array<char, 33>; // always terminated
+using response = lifx_response_t;
+
+// Awaits a single request. The awaiter lives in the awaiting coroutine's frame and is what the library's
+// callback points at, so nothing is allocated per request. The coroutine is resumed from inside
+// context::handle_packet or context::tick, on whichever thread calls them.
+// Result is nullopt if the request timed out or couldn't be made (the request table is full, or the device isn't a light.)
+template <typename T, T (*Extract)(const response &)>
+class request_awaiter
+{
+public:
+    request_awaiter(lifx_device_t *device, lifx_request_type_t type, uint32_t timeout_ms)
+        : device_(device), type_(type), timeout_ms_(timeout_ms) { }
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        handle_ = handle;
+        // carry straight on if the request couldn't be sent
+        return lifx_request(device_, type_, timeout_ms_, &request_awaiter::complete, this) >= 0;
+    }
+
+    std::optional<T> await_resume() const noexcept
+    {
+        if (!completed_)
+            return std::nullopt;
+        return Extract(response_);
+    }
+
+private:
+    static void complete(lifx_request_t, lifx_device_t *, lifx_request_status_t status, const lifx_response_t *reply, void *context)
+    {
+        request_awaiter *self = static_cast<request_awaiter *>(context);
+        if (status == LIFX_REQUEST_COMPLETE) {
+            self->response_ = *reply;
+            self->completed_ = true;
+        }
+        self->handle_.resume();
+    }
+
+    lifx_device_t *device_;
+    lifx_request_type_t type_;
+    uint32_t timeout_ms_;
+    std::coroutine_handle<> handle_;
+    response response_;
+    bool completed_ = false;
+};
+
+namespace detail {
+inline response whole(const response &reply) { return reply; }
+inline hsbk light(const response &reply) { return reply.light; }
+inline uint16_t power(const response &reply) { return reply.power; }
+inline uint32_t product(const response &reply) { return reply.product; }
+inline label text(const response &reply)
+{
+    label result;
+    std::memcpy(result.data(), reply.label, result.size());
+    return result;
+}
+}
+
+// Non-owning handle to a device in the library's table, valid until the library is reinitialised.
+class device
+{
+public:
+    explicit device(lifx_device_t *handle = nullptr) : handle_(handle) { }
+
+    explicit operator bool() const { return handle_ != nullptr; }
+    lifx_device_t *handle() const { return handle_; }
+    bool operator==(const device &other) const { return handle_ == other.handle_; }
+
+    const uint8_t *mac() const { return lifx_get_device_mac(handle_); }
+    uint32_t ipv4() const { return lifx_get_device_ipv4(handle_); }
+    int product() const { return lifx_get_device_product(handle_); }
+    int latency() const { return lifx_get_device_latency(handle_); }
+    std::string_view cached_label() const { return lifx_get_device_label(handle_); }
+    bool is_light() const { return lifx_product_is_light(product()); }
+
+    request_awaiter<response, detail::whole> request(lifx_request_type_t type, uint32_t timeout_ms = 0) const
+    {
+        return { handle_, type, timeout_ms };
+    }
+    request_awaiter<label, detail::text> get_label(uint32_t timeout_ms = 0) const
+    {
+        return { handle_, LIFX_REQUEST_LABEL, timeout_ms };
+    }
+    request_awaiter<uint32_t, detail::product> get_product(uint32_t timeout_ms = 0) const
+    {
+        return { handle_, LIFX_REQUEST_VERSION, timeout_ms };
+    }
+
+protected:
+    lifx_device_t *handle_;
+};
+
+// Handle to a device that's known to be a light, get one from context::light.
+class light : public device
+{
+public:
+    using device::device;
+
+    // The cached (or predicted, during a transition) colour, nullopt if the device isn't a light.
+    std::optional<hsbk> color() const
+    {
+        hsbk value;
+        if (lifx_get_light_hsbk(handle_, &value.hue, &value.saturation, &value.brightness, &value.kelvin) != 0)
+            return std::nullopt;
+        return value;
+    }
+    bool powered() const { return lifx_is_light_powered(handle_); }
+
+    // Sets the colour over time_ms. Nothing to await, LIFX answers with the state from before the change, so
+    // co_await get_color() once the transition is done to see where the light got to.
+    void set_color(hsbk color, uint32_t time_ms = 0) const
+    {
+        lifx_set_light_hsbk(handle_, color.hue, color.saturation, color.brightness, color.kelvin, time_ms);
+    }
+    // Powers the light on or off over time_ms, co_await get_power() afterwards to check.
+    void set_powered(bool powered, uint32_t time_ms = 0) const { lifx_set_light_powered(handle_, powered, time_ms); }
+    request_awaiter<hsbk, detail::light> get_color(uint32_t timeout_ms = 0) const
+    {
+        return { handle_, LIFX_REQUEST_LIGHT_STATE, timeout_ms };
+    }
+    request_awaiter<uint16_t, detail::power> get_power(uint32_t timeout_ms = 0) const
+    {
+        return { handle_, LIFX_REQUEST_LIGHT_POWER, timeout_ms };
+    }
+};
+
+// Owns the library's state, only one can exist at a time as the library keeps it globally.
+// Destroying it forgets every device and pending request without calling their callbacks.
+class context
+{
+public:
+    explicit context(lifx_send_packet_t send_packet, lifx_device_update_t device_update = nullptr)
+    {
+        lifx_init(send_packet, device_update);
+    }
+    ~context() { lifx_init(&context::discard, nullptr); }
+    context(const context &) = delete;
+    context &operator=(const context &) = delete;
+
+    void handle_packet(uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port) { lifx_handle_incoming_packet(packet, length, ipv4, port); }
+    void tick() { lifx_tick(); }
+    int32_t next_deadline() const { return lifx_get_next_deadline(); }
+    void discover() { lifx_discover_devices(); }
+
+    int device_count() const { return lifx_get_device_count(); }
+    device device_at(int num) const { return device(lifx_get_device_from_num(num)); }
+    device find(const uint8_t mac[6]) const { return device(lifx_get_device(const_cast<uint8_t *>(mac))); }
+    // Gets a light handle, which is empty if the device isn't a light.
+    static light as_light(device dev) { return light(dev && dev.is_light() ? dev.handle() : nullptr); }
+    int pending_requests() const { return lifx_get_pending_request_count(); }
+
+    lifx_stats_t stats() const
+    {
+        lifx_stats_t result;
+        lifx_get_stats(&result);
+        return result;
+    }
+
+private:
+    static void discard(uint8_t *, size_t, uint32_t, uint16_t) { }
+};
+
+// Minimal coroutine type for fire-and-forget work driven by the context, it starts straight away
+// and frees itself when it finishes. Bring your own task type if you need results or cancellation.
+struct task
+{
+    struct promise_type
+    {
+        task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept { }
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+} // namespace lifx
+
+#endif // LIFX_HPP_
@@ -0,0 +1,213 @@
+/*
+    liblifx - lifx_config.h
+    Compile-time options for trading features for RAM and flash.
+*/
+
+#ifndef LIFX_CONFIG_H_
+#define LIFX_CONFIG_H_
+
+// Profiles set a group of the options below, pick one with -DLIFX_PROFILE_...
+// or PROFILE=... when using the Makefile. Any option can still be set by hand.
+// Options change struct layouts in lifx.h, so programs using the library must be built with the same ones.
+// make writes the profile to lifx_profile.h next to this file, and it's picked up from there.
+//  desktop  - everything enabled (default)
+//  embedded - 16 devices, fixed-point colour, no stdio, no interface scanning, no shared memory, no product names,
+//             compact product table
+//  tiny     - as embedded, but 4 devices and no statistics, firmware effects, link monitoring, send queue,
+//             interfaces, device queries, snapshots, scenes or the reconciler
+
+#if defined(__has_include)
+#if __has_include(<lifx_profile.h>)
+#include <lifx_profile.h>
+#endif
+#endif
+
+#if defined(LIFX_PROFILE_EMBEDDED) || defined(LIFX_PROFILE_TINY)
+#ifdef LIFX_PROFILE_TINY
+#ifndef LIFX_MAX_DEVICE_COUNT
+#define LIFX_MAX_DEVICE_COUNT 4
+#endif
+#ifndef LIFX_NO_STATS
+#define LIFX_NO_STATS
+#endif
+#ifndef LIFX_NO_EFFECTS
+#define LIFX_NO_EFFECTS
+#endif
+#ifndef LIFX_MAX_PENDING_REQUESTS
+#define LIFX_MAX_PENDING_REQUESTS 4
+#endif
+#ifndef LIFX_MAX_SCHEDULED_COMMANDS
+#define LIFX_MAX_SCHEDULED_COMMANDS 4
+#endif
+#ifndef LIFX_NO_LINK
+#define LIFX_NO_LINK
+#endif
+#ifndef LIFX_NO_SEND_QUEUE
+#define LIFX_NO_SEND_QUEUE
+#endif
+#ifndef LIFX_NO_INTERFACES
+#define LIFX_NO_INTERFACES
+#endif
+#ifndef LIFX_NO_QUERY
+#define LIFX_NO_QUERY
+#endif
+#ifndef LIFX_NO_SCENES
+#define LIFX_NO_SCENES
+#endif
+#ifndef LIFX_NO_RECONCILE
+#define LIFX_NO_RECONCILE
+#endif
+#endif
+#ifndef LIFX_FIXED_POINT
+#define LIFX_FIXED_POINT
+#endif
+#ifndef LIFX_NO_STDIO
+#define LIFX_NO_STDIO
+#endif
+#ifndef LIFX_NO_SYSTEM_TIME
+#define LIFX_NO_SYSTEM_TIME
+#endif
+#ifndef LIFX_NO_IFADDRS
+#define LIFX_NO_IFADDRS
+#endif
+#ifndef LIFX_NO_SHM
+#define LIFX_NO_SHM
+#endif
+#ifndef LIFX_NO_PRODUCT_NAMES
+#define LIFX_NO_PRODUCT_NAMES
+#endif
+#ifndef LIFX_COMPACT_PRODUCTS
+#define LIFX_COMPACT_PRODUCTS
+#endif
+#ifndef LIFX_DEVICE_ALIGN
+#define LIFX_DEVICE_ALIGN 4
+#endif
+#ifndef LIFX_STATS_TYPE_COUNT
+#define LIFX_STATS_TYPE_COUNT 128
+#endif
+#ifndef LIFX_MAX_PENDING_REQUESTS
+#define LIFX_MAX_PENDING_REQUESTS 16
+#endif
+#ifndef LIFX_MAX_SCHEDULED_COMMANDS
+#define LIFX_MAX_SCHEDULED_COMMANDS 16
+#endif
+#ifndef LIFX_SEND_QUEUE_SIZE
+#define LIFX_SEND_QUEUE_SIZE 4
+#endif
+#ifndef LIFX_MAX_INTERFACES
+#define LIFX_MAX_INTERFACES 2
+#endif
+#endif
+
+// Number of devices the device table can hold.
+#ifndef LIFX_MAX_DEVICE_COUNT
+#define LIFX_MAX_DEVICE_COUNT 16
+#endif
+
+// Largest packet the library sends or accepts, tile effects need 224 bytes.
+#ifndef LIFX_MAX_PACKET_SIZE
+#ifndef LIFX_NO_EFFECTS
+#define LIFX_MAX_PACKET_SIZE 0x100
+#else
+#define LIFX_MAX_PACKET_SIZE 0x80
+#endif
+#endif
+
+// Alignment of each device's frequently used data, 64 keeps every device in its own cache line.
+#ifndef LIFX_DEVICE_ALIGN
+#define LIFX_DEVICE_ALIGN 64
+#endif
+
+// Number of asynchronous requests that can wait for a reply at once, a power of two up to 256.
+#ifndef LIFX_MAX_PENDING_REQUESTS
+#define LIFX_MAX_PENDING_REQUESTS 256
+#endif
+
+// Milliseconds before a request with no timeout given gives up waiting.
+#ifndef LIFX_REQUEST_TIMEOUT_MS
+#define LIFX_REQUEST_TIMEOUT_MS 1000
+#endif
+
+// Number of commands lifx_apply_synchronized can hold back at once.
+#ifndef LIFX_MAX_SCHEDULED_COMMANDS
+#define LIFX_MAX_SCHEDULED_COMMANDS 256
+#endif
+
+// Packets each priority class of the send queue can hold while the transport is blocked.
+#ifndef LIFX_SEND_QUEUE_SIZE
+#define LIFX_SEND_QUEUE_SIZE 16
+#endif
+
+// Snapshots filter devices with the query bitsets, so they go too.
+#if defined(LIFX_NO_QUERY) && !defined(LIFX_NO_SNAPSHOT)
+#define LIFX_NO_SNAPSHOT
+#endif
+
+// The shared memory table is made of snapshot records.
+#if defined(LIFX_NO_SNAPSHOT) && !defined(LIFX_NO_SHM)
+#define LIFX_NO_SHM
+#endif
+
+// Longest the shared memory table goes without being brought up to date, while something is published.
+#ifndef LIFX_SHM_INTERVAL_MS
+#define LIFX_SHM_INTERVAL_MS 100
+#endif
+
+// Scenes are sent as scheduled commands, so they go with the schedule.
+#if defined(LIFX_NO_SCHEDULE) && !defined(LIFX_NO_SCENES)
+#define LIFX_NO_SCENES
+#endif
+
+// Packets a second the reconciler can send, for all the lights with a target together.
+#ifndef LIFX_RECONCILE_RATE
+#define LIFX_RECONCILE_RATE 20
+#endif
+
+// Longest the reconciler waits before trying a light again that isn't answering or keeps diverging.
+#ifndef LIFX_RECONCILE_MAX_BACKOFF_MS
+#define LIFX_RECONCILE_MAX_BACKOFF_MS 60000
+#endif
+
+// Milliseconds between checking that converged lights still have their target.
+#ifndef LIFX_RECONCILE_CHECK_MS
+#define LIFX_RECONCILE_CHECK_MS 30000
+#endif
+
+// Number of local network interfaces discovery can broadcast on.
+#ifndef LIFX_MAX_INTERFACES
+#define LIFX_MAX_INTERFACES 8
+#endif
+
+// Milliseconds between asking each device for its Wi-Fi signal.
+#ifndef LIFX_LINK_POLL_MS
+#define LIFX_LINK_POLL_MS 30000
+#endif
+
+// Message types at or above this are counted in the last slot of the per-type statistics.
+#ifndef LIFX_STATS_TYPE_COUNT
+#define LIFX_STATS_TYPE_COUNT 1024
+#endif
+
+// LIFX_FIXED_POINT       - only the uint16 HSBK colour functions are built, no doubles are used.
+// LIFX_NO_STDIO          - leaves out the device cache and packet capture, which need files and threads.
+// LIFX_NO_STATS          - leaves out the traffic counters, lifx_get_stats returns all zeroes.
+// LIFX_NO_SYSTEM_TIME    - doesn't use clock_gettime, srand or time. The caller must provide
+//                          uint64_t lifx_platform_time_ms(void), which is the default clock
+//                          until lifx_set_clock is called, and should call lifx_set_source
+//                          with a random value after lifx_init.
+// LIFX_NO_EFFECTS        - leaves out the multizone and tile firmware effects and their per-device state.
+// LIFX_NO_REQUESTS       - leaves out lifx_request and the table of requests waiting for a reply.
+// LIFX_NO_SCHEDULE       - leaves out lifx_apply_synchronized and its queue of commands.
+// LIFX_NO_SCENES         - leaves out lifx_apply_scene and the per-device confirmations it waits for, implied by LIFX_NO_SCHEDULE.
+// LIFX_NO_RECONCILE      - leaves out lifx_set_target and the per-light targets it keeps lights at.
+// LIFX_NO_LINK           - leaves out Wi-Fi polling, colour resends and lifx_stream_light_hsbk.
+// LIFX_NO_SEND_QUEUE     - leaves out lifx_set_try_send and the queue of packets waiting for the transport.
+// LIFX_NO_INTERFACES     - leaves out the interface table, discovery only uses the 255.255.255.255 broadcast.
+// LIFX_NO_IFADDRS        - leaves out lifx_scan_interfaces, which needs getifaddrs. Interfaces can still be added by hand.
+// LIFX_NO_QUERY          - leaves out lifx_query_devices and the per-property bitsets it reads.
+// LIFX_NO_SNAPSHOT       - leaves out lifx_snapshot_devices and the per-device generations, implied by LIFX_NO_QUERY.
+// LIFX_NO_SHM            - leaves out publishing the device table to POSIX shared memory, implied by LIFX_NO_SNAPSHOT.
+// LIFX_NO_PRODUCT_NAMES  - lifx_get_product_name always returns "Unknown Product".
+// LIFX_COMPACT_PRODUCTS  - the product table only keeps IDs and capability bits.
+
+#endif // LIFX_CONFIG_H_
@@ -4,7 +4,10 @@
 */
 
 #include <string.h>
-#include <sys/time.h>
+#include <lifx_config.h>
+#ifndef LIFX_NO_SYSTEM_TIME
+#include <time.h>
+#endif
 
 #include "lifx_products.h"
 #include "lifx_internal.h"
@@ -12,37 +15,109 @@
 #include <lifx.h>
 
 static lifx_device_t devices[LIFX_MAX_DEVICE_COUNT];
+static lifx_device_info_t devices_info[LIFX_MAX_DEVICE_COUNT];
 static int devices_count = 0;
+static int transitions_count = 0; // devices with LIFX_DEVICE_TRANSITION set, so lifx_tick can skip looking for them
 static int source_value = 0;
-static uint64_t last_discover_timestamp = 0;
+static uint8_t sequence_value = 0;
+static uint64_t time_epoch = 0;
+static uint32_t last_discover_timestamp = 0;
+static uint8_t last_discover_sequence = 0; // replies carrying any other sequence answer an older discovery
+static_assert(sizeof(lifx_device_t) <= 64, "hot device data fits in a cache line");
 
 static lifx_send_packet_t lifx_send_outgoing_packet = NULL;
+#ifndef LIFX_NO_SEND_QUEUE
+static lifx_try_send_packet_t lifx_try_send_outgoing_packet = NULL;
+#endif
+#ifndef LIFX_NO_INTERFACES
+static lifx_send_interface_packet_t lifx_send_interface_packet = NULL;
+#endif
 static lifx_device_update_t lifx_device_update = NULL;
 
+#ifndef LIFX_NO_STATS
+static lifx_stats_t stats;
+
+#define LIFX_STATS_TYPE(type) ((type) < LIFX_STATS_TYPE_COUNT ? (type) : LIFX_STATS_TYPE_COUNT - 1)
+#define LIFX_STATS_DROP(reason) stats.drops[reason]++
+#define LIFX_STATS_ADD(counter, amount) stats.counter += (amount)
+#define LIFX_STATS_TYPE_ADD(counter, type, amount) stats.counter[LIFX_STATS_TYPE(type)] += (amount)
+#else
+#define LIFX_STATS_DROP(reason) do { } while (0)
+#define LIFX_STATS_ADD(counter, amount) do { } while (0)
+#define LIFX_STATS_TYPE_ADD(counter, type, amount) do { } while (0)
+#endif
+
 // -- START CORE LIBRARY FUNCTIONS --
 
+#ifndef LIFX_NO_SYSTEM_TIME
+// the coarse clock is read from the vDSO without a syscall, and its resolution (a few ms) is plenty for us
+#ifdef CLOCK_MONOTONIC_COARSE
+#define LIFX_CLOCK_ID CLOCK_MONOTONIC_COARSE
+#else
+#define LIFX_CLOCK_ID CLOCK_MONOTONIC
+#endif
+
+static uint64_t lifx_system_time_ms()
+{
+    struct timespec ts;
+    clock_gettime(LIFX_CLOCK_ID, &ts);
+    return ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+}
+
+static lifx_clock_t lifx_clock = lifx_system_time_ms;
+#else
+static lifx_clock_t lifx_clock = lifx_platform_time_ms;
+#endif
+
 static uint64_t lifx_get_time_ms()
 {
-    struct timeval te; 
-    gettimeofday(&te, NULL);
-    return (te.tv_sec * 1000LL + te.tv_usec / 1000);
+    return lifx_clock();
+}
+
+void lifx_set_clock(lifx_clock_t clock)
+{
+    // carry on from the same relative time so existing device timestamps stay meaningful
+    uint32_t time_now = lifx_get_time_relative();
+#ifndef LIFX_NO_SYSTEM_TIME
+    lifx_clock = clock != NULL ? clock : lifx_system_time_ms;
+#else
+    lifx_clock = clock != NULL ? clock : lifx_platform_time_ms;
+#endif
+    time_epoch = lifx_get_time_ms() - time_now;
+}
+
+uint32_t lifx_get_time_relative()
+{
+    return (uint32_t)(lifx_get_time_ms() - time_epoch);
 }
 
-static lifx_device_t *lifx_get_device_internal(uint8_t mac[6], bool create)
+lifx_device_info_t *lifx_get_device_info(lifx_device_t *device)
+{
+    return &devices_info[device - devices];
+}
+
+lifx_device_t *lifx_get_device_internal(uint8_t mac[6], bool create)
 {
     for (int i = 0; i < devices_count; i++) {
         lifx_device_t *device = &devices[i];
-        if (device->in_use && memcmp(mac, device->mac, 6) == 0)
+        if ((device->flags & LIFX_DEVICE_IN_USE) && memcmp(mac, device->mac, 6) == 0)
             return device;
     }
     if (devices_count < LIFX_MAX_DEVICE_COUNT && create) {
         lifx_device_t *device = &devices[devices_count];
         memset(device, 0, sizeof(lifx_device_t));
+        memset(&devices_info[devices_count], 0, sizeof(lifx_device_info_t));
         memcpy(device->mac, mac, 6);
-        device->in_use = true;
+        device->flags = LIFX_DEVICE_IN_USE;
+#ifndef LIFX_NO_INTERFACES
+        device->interface = -1;
+#endif
         devices_count++;
+        LIFX_CHANGED(device);
         return device;
     }
+    if (create)
+        LIFX_STATS_ADD(table_full, 1);
     return NULL;
 }
 
@@ -53,12 +128,12 @@ lifx_device_t *lifx_get_device(uint8_t mac[6])
 
 lifx_device_t *lifx_get_device_from_num(int num)
 {
-    lifx_device_t *device = &devices[num];
-    if (num >= LIFX_MAX_DEVICE_COUNT)
+    if (num < 0 || num >= LIFX_MAX_DEVICE_COUNT)
         return NULL;
-    if (device->in_use == false)
+    lifx_device_t *device = &devices[num];
+    if (!(device->flags & LIFX_DEVICE_IN_USE))
         return NULL;
-    return &devices[num];
+    return device;
 }
 
 lifx_device_t *lifx_get_devices()
@@ -75,15 +150,64 @@ void lifx_init(lifx_send_packet_t send_packet, lifx_device_update_t device_updat
 {
     // set the outgoing packet function
     lifx_send_outgoing_packet = send_packet;
+#ifndef LIFX_NO_SEND_QUEUE
+    lifx_try_send_outgoing_packet = NULL;
+    lifx_reset_queue();
+#endif
+#ifndef LIFX_NO_INTERFACES
+    lifx_send_interface_packet = NULL;
+    lifx_reset_interfaces();
+#endif
     // clear the devices array
     memset(devices, 0, sizeof(devices));
+    memset(devices_info, 0, sizeof(devices_info));
     devices_count = 0;
+    transitions_count = 0;
+    // device timestamps are stored relative to this
+    time_epoch = lifx_get_time_ms();
+    lifx_reset_stats();
+#ifndef LIFX_NO_QUERY
+    lifx_reset_query();
+#endif
+#ifndef LIFX_NO_SNAPSHOT
+    lifx_reset_snapshot();
+#endif
+#ifndef LIFX_NO_SHM
+    lifx_reset_shm();
+#endif
+#ifndef LIFX_NO_REQUESTS
+    lifx_reset_requests();
+#endif
+#ifndef LIFX_NO_SCHEDULE
+    lifx_reset_schedule();
+#endif
+#ifndef LIFX_NO_SCENES
+    lifx_reset_scenes();
+#endif
+#ifndef LIFX_NO_RECONCILE
+    lifx_reset_reconcile();
+#endif
     // set the device update function, if it's been set
     if (device_update != NULL)
         lifx_device_update = device_update;
+#ifndef LIFX_NO_SYSTEM_TIME
     // set our source value to something random
     srand(time(NULL));
     source_value = rand();
+#else
+    // no randomness to be had, the caller should pick a better one with lifx_set_source
+    source_value = (uint32_t)time_epoch ^ 0x4C494658;
+#endif
+}
+
+void lifx_set_source(uint32_t source)
+{
+    source_value = source;
+}
+
+uint32_t lifx_get_source()
+{
+    return source_value;
 }
 
 void lifx_flip_header(lifx_header_t *header)
@@ -92,12 +216,76 @@ void lifx_flip_header(lifx_header_t *header)
     header->frame.size = LE16(header->frame.size);
     header->frame.source = LE(header->frame.source);
     header->protocol.type = LE16(header->protocol.type);
-    // HACK - is there a better way to do this?
-    ((uint16_t *)header)[1] = LE16(((uint16_t *)header)[1]);
+    // the protocol bitfield shares a little endian word with the flags that follow it
+    uint16_t word;
+    memcpy(&word, (uint8_t *)header + 2, sizeof(word));
+    word = LE16(word);
+    memcpy((uint8_t *)header + 2, &word, sizeof(word));
+#endif
+}
+
+#ifndef LIFX_NO_SEND_QUEUE
+void lifx_set_try_send(lifx_try_send_packet_t try_send)
+{
+    lifx_try_send_outgoing_packet = try_send;
+}
+#endif
+
+#ifndef LIFX_NO_INTERFACES
+void lifx_set_interface_send(lifx_send_interface_packet_t send)
+{
+    lifx_send_interface_packet = send;
+}
+#endif
+
+int lifx_transmit(uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port, int interface)
+{
+#ifndef LIFX_NO_INTERFACES
+    if (lifx_send_interface_packet != NULL) {
+        if (lifx_send_interface_packet(packet, length, ipv4, port, interface) != 0)
+            return -1;
+    } else
+#endif
+#ifndef LIFX_NO_SEND_QUEUE
+    if (lifx_try_send_outgoing_packet != NULL) {
+        if (lifx_try_send_outgoing_packet(packet, length, ipv4, port) != 0)
+            return -1;
+    } else
 #endif
+    lifx_send_outgoing_packet(packet, length, ipv4, port);
+    // only count what actually made it to the transport, the header has already been flipped
+#ifndef LIFX_NO_STATS
+    uint16_t packet_type = lifx_read_u16(packet + offsetof(lifx_header_t, protocol.type));
+    LIFX_STATS_ADD(packets_out, 1);
+    LIFX_STATS_ADD(bytes_out, length);
+    LIFX_STATS_TYPE_ADD(type_packets_out, packet_type, 1);
+    LIFX_STATS_TYPE_ADD(type_bytes_out, packet_type, length);
+#endif
+    LIFX_CAPTURE(packet, length, true, ipv4, port);
+    return 0;
+}
+
+uint8_t lifx_send_packet(lifx_device_t *target_device, uint16_t packet_type, void *extra_data, size_t extra_size)
+{
+    return lifx_send_packet_priority(target_device, packet_type, extra_data, extra_size, LIFX_PRIORITY_INTERACTIVE);
 }
 
-void lifx_send_packet(lifx_device_t *target_device, uint16_t packet_type, void *extra_data, size_t extra_size)
+uint8_t lifx_next_sequence()
+{
+    return sequence_value++;
+}
+
+uint8_t lifx_send_packet_priority(lifx_device_t *target_device, uint16_t packet_type, void *extra_data, size_t extra_size,
+    lifx_priority_t priority)
+{
+    uint8_t sequence = lifx_next_sequence();
+    lifx_send_packet_sequence(target_device, packet_type, extra_data, extra_size, sequence, priority);
+    return sequence;
+}
+
+// sends to the device if there is one, otherwise sends a tagged packet to ipv4, port and interface
+static void lifx_send_packet_address(lifx_device_t *target_device, uint16_t packet_type, void *extra_data, size_t extra_size,
+    uint8_t sequence, lifx_priority_t priority, uint32_t ipv4, uint16_t port, int interface)
 {
     uint8_t packet_data[LIFX_MAX_PACKET_SIZE];
     lifx_header_t *lifx_packet = (lifx_header_t *)packet_data;
@@ -109,6 +297,7 @@ void lifx_send_packet(lifx_device_t *target_device, uint16_t packet_type, void *
     lifx_packet->frame.addressable = true;
     lifx_packet->frame.source = source_value;
     lifx_packet->address.res_required = true;
+    lifx_packet->address.sequence = sequence;
     lifx_packet->protocol.type = packet_type;
 
     if (extra_data != NULL && extra_size > 0 && extra_size < LIFX_MAX_PACKET_SIZE - sizeof(lifx_header_t)) {
@@ -116,268 +305,981 @@ void lifx_send_packet(lifx_device_t *target_device, uint16_t packet_type, void *
     }
 
     if (target_device != NULL) {
+        uint32_t time_now = lifx_get_time_relative();
         memcpy(lifx_packet->address.mac, target_device->mac, 6);
-        target_device->last_send = lifx_get_time_ms();
-        lifx_flip_header(lifx_packet);
-        lifx_send_outgoing_packet(packet_data, packet_size, target_device->ipv4, target_device->port);
+        // count sends to devices we haven't heard from in a while, they'll probably go nowhere
+        if (!(target_device->flags & LIFX_DEVICE_SEEN) || time_now - target_device->last_update > LIFX_DEVICE_OFFLINE_MS)
+            LIFX_STATS_ADD(sends_offline, 1);
+        target_device->last_send = time_now;
+        ipv4 = target_device->ipv4;
+        port = target_device->port;
+#ifndef LIFX_NO_INTERFACES
+        interface = target_device->interface;
+#endif
     } else {
         lifx_packet->frame.tagged = true;
-        lifx_flip_header(lifx_packet);
-        lifx_send_outgoing_packet(packet_data, packet_size, LIFX_BROADCAST_IPV4, LIFX_BROADCAST_PORT);
     }
+    lifx_flip_header(lifx_packet);
+#ifndef LIFX_NO_SEND_QUEUE
+    lifx_queue_send(priority, packet_data, packet_size, ipv4, port, interface);
+#else
+    lifx_transmit(packet_data, packet_size, ipv4, port, interface);
+#endif
+}
+
+void lifx_send_packet_sequence(lifx_device_t *target_device, uint16_t packet_type, void *extra_data, size_t extra_size, uint8_t sequence,
+    lifx_priority_t priority)
+{
+    lifx_send_packet_address(target_device, packet_type, extra_data, extra_size, sequence, priority, LIFX_BROADCAST_IPV4,
+        LIFX_BROADCAST_PORT, -1);
 }
 
 void lifx_discover_devices()
 {
-    last_discover_timestamp = lifx_get_time_ms();
-    lifx_send_packet(NULL, LIFX_PT_GETSERVICE, NULL, 0);
+    last_discover_timestamp = lifx_get_time_relative();
+    last_discover_sequence = lifx_next_sequence();
+#ifndef LIFX_NO_INTERFACES
+    // 255.255.255.255 only leaves by one interface, so send a directed broadcast to each subnet instead
+    int count = lifx_get_interface_count();
+    if (count > 0) {
+        for (int i = 0; i < count; i++) {
+            lifx_interface_t interface;
+            lifx_get_interface(i, &interface);
+            lifx_send_packet_address(NULL, LIFX_PT_GETSERVICE, NULL, 0, last_discover_sequence, LIFX_PRIORITY_BACKGROUND,
+                interface.broadcast, LIFX_BROADCAST_PORT, i);
+        }
+        return;
+    }
+#endif
+    lifx_send_packet_sequence(NULL, LIFX_PT_GETSERVICE, NULL, 0, last_discover_sequence, LIFX_PRIORITY_BACKGROUND);
+}
+
+void lifx_discover_device(uint32_t ipv4)
+{
+    int interface = -1;
+#ifndef LIFX_NO_INTERFACES
+    interface = lifx_find_interface(ipv4);
+#endif
+    last_discover_timestamp = lifx_get_time_relative();
+    last_discover_sequence = lifx_next_sequence();
+    lifx_send_packet_address(NULL, LIFX_PT_GETSERVICE, NULL, 0, last_discover_sequence, LIFX_PRIORITY_BACKGROUND, ipv4,
+        LIFX_BROADCAST_PORT, interface);
 }
 
 void lifx_poll_system(lifx_device_t *device)
 {
-    lifx_send_packet(device, LIFX_PT_GETVERSION, NULL, 0);
-    lifx_send_packet(device, LIFX_PT_GETHOSTFIRMWARE, NULL, 0);
-    // uncomment when section code is done
-    // lifx_send_packet(device, LIFX_PT_GETLOCATION, NULL, 0);
-    // lifx_send_packet(device, LIFX_PT_GETGROUP, NULL, 0);
+    lifx_send_packet_priority(device, LIFX_PT_GETVERSION, NULL, 0, LIFX_PRIORITY_BACKGROUND);
+    lifx_send_packet_priority(device, LIFX_PT_GETHOSTFIRMWARE, NULL, 0, LIFX_PRIORITY_BACKGROUND);
+    lifx_send_packet_priority(device, LIFX_PT_GETLOCATION, NULL, 0, LIFX_PRIORITY_BACKGROUND);
+    lifx_send_packet_priority(device, LIFX_PT_GETGROUP, NULL, 0, LIFX_PRIORITY_BACKGROUND);
 }
 
 void lifx_poll_light(lifx_device_t *device)
 {
-    lifx_send_packet(device, LIFX_PT_GETCOLOR, NULL, 0);
+    lifx_send_packet_priority(device, LIFX_PT_GETCOLOR, NULL, 0, LIFX_PRIORITY_BACKGROUND);
 }
 
-void lifx_handle_incoming_packet(uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port)
+// handlers for packets from known devices, the payload has already been checked against the message size
+typedef void (*lifx_handler_t)(lifx_device_t *device, const uint8_t *payload);
+
+static void lifx_handle_state_host_firmware(lifx_device_t *device, const uint8_t *payload)
+{
+    lifx_state_host_firmware_t fw;
+    lifx_decode_state_host_firmware(&fw, payload);
+    // a firmware change can change what the device reports about itself, so refresh it
+    lifx_device_info_t *info = lifx_get_device_info(device);
+    bool firmware_changed = info->version.build != 0 && info->version.build != fw.build;
+    if (info->version.build != fw.build || info->version.major != fw.version_major || info->version.minor != fw.version_minor)
+        LIFX_CHANGED(device);
+    info->version.build = fw.build;
+    info->version.major = fw.version_major;
+    info->version.minor = fw.version_minor;
+    if (firmware_changed)
+        lifx_send_packet_priority(device, LIFX_PT_GETVERSION, NULL, 0, LIFX_PRIORITY_BACKGROUND);
+}
+
+static void lifx_handle_state_version(lifx_device_t *device, const uint8_t *payload)
+{
+    lifx_state_version_t ver;
+    lifx_decode_state_version(&ver, payload);
+    lifx_get_device_info(device)->vendor = ver.vendor;
+    lifx_set_device_product(device, ver.product);
+    if (device->flags & LIFX_DEVICE_IS_LIGHT)
+        lifx_poll_light(device);
+    else // the light state packet includes the label, for non-lights ask politely
+        lifx_send_packet_priority(device, LIFX_PT_GETLABEL, NULL, 0, LIFX_PRIORITY_BACKGROUND);
+#ifndef LIFX_NO_EFFECTS
+    // find out if it's already running an effect
+    if (device->flags & (LIFX_DEVICE_MULTIZONE | LIFX_DEVICE_MATRIX))
+        lifx_request_effect(device);
+#endif
+}
+
+static void lifx_handle_state_label(lifx_device_t *device, const uint8_t *payload)
+{
+    // the label is the whole payload, copy it straight in
+    lifx_device_info_t *info = lifx_get_device_info(device);
+    if (memcmp(info->label, payload, LIFX_STATE_LABEL_SIZE) != 0)
+        LIFX_CHANGED(device);
+    memcpy(info->label, payload, LIFX_STATE_LABEL_SIZE);
+}
+
+static void lifx_end_transition(lifx_device_t *device)
+{
+    device->flags &= ~LIFX_DEVICE_TRANSITION;
+    transitions_count--;
+}
+
+static void lifx_handle_light_state(lifx_device_t *device, const uint8_t *payload)
+{
+    lifx_light_state_t light;
+    lifx_decode_light_state(&light, payload);
+    if (memcmp(&device->light, &light.color, sizeof(lifx_hsbk_t)) != 0 || device->power != light.power)
+        LIFX_CHANGED(device);
+    device->light = light.color;
+    device->power = light.power;
+    device->flags |= LIFX_DEVICE_STATE_KNOWN;
+#ifndef LIFX_NO_QUERY
+    lifx_query_set(device, LIFX_QUERY_POWERED, light.power == 0xFFFF);
+#endif
+    lifx_device_info_t *info = lifx_get_device_info(device);
+    // if we're part way through a transition, carry on predicting from what the device reported
+    if (device->flags & LIFX_DEVICE_TRANSITION) {
+        uint32_t elapsed = lifx_get_time_relative() - info->transition_start;
+        if (elapsed < info->transition_duration) {
+            info->transition_from = device->light;
+            info->transition_start += elapsed;
+            info->transition_duration -= elapsed;
+        } else {
+            lifx_end_transition(device);
+        }
+    }
+    if (!(device->flags & LIFX_DEVICE_TRANSITION))
+        device->flags &= ~LIFX_DEVICE_PREDICTED;
+    // labels rarely change, only write to the cold data when it has
+    if (memcmp(info->label, light.label, 32) != 0) {
+        memcpy(info->label, light.label, 32);
+        LIFX_CHANGED(device);
+    }
+#ifndef LIFX_NO_RECONCILE
+    lifx_reconcile_reported(device, true);
+#endif
+}
+
+static void lifx_handle_state_light_power(lifx_device_t *device, const uint8_t *payload)
+{
+    lifx_state_light_power_t power;
+    lifx_decode_state_light_power(&power, payload);
+    if (device->power != power.level)
+        LIFX_CHANGED(device);
+    device->power = power.level;
+#ifndef LIFX_NO_QUERY
+    lifx_query_set(device, LIFX_QUERY_POWERED, power.level == 0xFFFF);
+#endif
+#ifndef LIFX_NO_RECONCILE
+    lifx_reconcile_reported(device, false);
+#endif
+}
+
+static void lifx_set_section(lifx_device_t *device, lifx_section_t *section, const uint8_t uuid[16], const char label[32],
+    uint64_t updated_at)
+{
+    if (memcmp(section->uuid, uuid, sizeof(section->uuid)) != 0 || memcmp(section->label, label, sizeof(section->label)) != 0)
+        LIFX_CHANGED(device);
+    memcpy(section->uuid, uuid, sizeof(section->uuid));
+    memcpy(section->label, label, sizeof(section->label));
+    section->timestamp = updated_at;
+}
+
+static void lifx_handle_state_group(lifx_device_t *device, const uint8_t *payload)
+{
+    lifx_state_group_t group;
+    lifx_decode_state_group(&group, payload);
+    lifx_set_section(device, &lifx_get_device_info(device)->group, group.group, group.label, group.updated_at);
+#ifndef LIFX_NO_QUERY
+    lifx_query_set_group(device, group.group);
+#endif
+}
+
+static void lifx_handle_state_location(lifx_device_t *device, const uint8_t *payload)
+{
+    lifx_state_location_t location;
+    lifx_decode_state_location(&location, payload);
+    lifx_set_section(device, &lifx_get_device_info(device)->location, location.location, location.label, location.updated_at);
+#ifndef LIFX_NO_QUERY
+    lifx_query_set_location(device, location.location);
+#endif
+}
+
+#ifndef LIFX_NO_LINK
+static void lifx_handle_state_wifi_info(lifx_device_t *device, const uint8_t *payload)
 {
-    uint64_t time_now = lifx_get_time_ms();
+    lifx_state_wifi_info_t wifi;
+    lifx_decode_state_wifi_info(&wifi, payload);
+    lifx_link_set_signal(device, wifi.signal);
+}
+#endif
+
+#ifndef LIFX_NO_EFFECTS
+static void lifx_handle_state_multi_zone_effect(lifx_device_t *device, const uint8_t *payload)
+{
+    lifx_state_multi_zone_effect_t mz_effect;
+    lifx_decode_state_multi_zone_effect(&mz_effect, payload);
+    lifx_device_info_t *info = lifx_get_device_info(device);
+    memset(&info->effect, 0, sizeof(lifx_effect_t));
+    info->effect.type = mz_effect.type;
+    info->effect.instance_id = mz_effect.instance_id;
+    info->effect.speed_ms = mz_effect.speed;
+    info->effect.duration_ns = mz_effect.duration;
+    memcpy(info->effect.parameters, mz_effect.parameters, sizeof(info->effect.parameters));
+    device->flags |= LIFX_DEVICE_HAS_EFFECT;
+}
+
+static void lifx_handle_state_tile_effect(lifx_device_t *device, const uint8_t *payload)
+{
+    lifx_state_tile_effect_t tile_effect;
+    lifx_decode_state_tile_effect(&tile_effect, payload);
+    lifx_tile_effect_settings_t *settings = &tile_effect.settings;
+    lifx_device_info_t *info = lifx_get_device_info(device);
+    info->effect.type = settings->type;
+    info->effect.instance_id = settings->instance_id;
+    info->effect.speed_ms = settings->speed;
+    info->effect.duration_ns = settings->duration;
+    memcpy(info->effect.parameters, settings->parameters, sizeof(info->effect.parameters));
+    info->effect.palette_count = settings->palette_count;
+    if (info->effect.palette_count > LIFX_EFFECT_MAX_PALETTE)
+        info->effect.palette_count = LIFX_EFFECT_MAX_PALETTE;
+    memcpy(info->effect.palette, settings->palette, sizeof(info->effect.palette));
+    device->flags |= LIFX_DEVICE_HAS_EFFECT;
+}
+#endif
+
+// indexed by lifx_message_t, messages without a handler are dropped as unhandled
+static const lifx_handler_t lifx_handlers[LIFX_MESSAGE_COUNT] = {
+    [LIFX_MSG_STATE_HOST_FIRMWARE] = lifx_handle_state_host_firmware,
+    [LIFX_MSG_STATE_VERSION] = lifx_handle_state_version,
+    [LIFX_MSG_STATE_LABEL] = lifx_handle_state_label,
+    [LIFX_MSG_STATE_GROUP] = lifx_handle_state_group,
+    [LIFX_MSG_STATE_LOCATION] = lifx_handle_state_location,
+    [LIFX_MSG_LIGHT_STATE] = lifx_handle_light_state,
+    [LIFX_MSG_STATE_LIGHT_POWER] = lifx_handle_state_light_power,
+#ifndef LIFX_NO_LINK
+    [LIFX_MSG_STATE_WIFI_INFO] = lifx_handle_state_wifi_info,
+#endif
+#ifndef LIFX_NO_EFFECTS
+    [LIFX_MSG_STATE_MULTI_ZONE_EFFECT] = lifx_handle_state_multi_zone_effect,
+    [LIFX_MSG_STATE_TILE_EFFECT] = lifx_handle_state_tile_effect,
+#endif
+};
+
+// the device may have moved, or been loaded from the cache without knowing which interface it's on
+static void lifx_set_device_address(lifx_device_t *device, uint32_t ipv4, uint16_t port)
+{
+#ifndef LIFX_NO_INTERFACES
+    if (device->ipv4 != ipv4 || device->interface < 0)
+        device->interface = lifx_find_interface(ipv4);
+#endif
+    if (device->ipv4 != ipv4 || device->port != port)
+        LIFX_CHANGED(device);
+    device->ipv4 = ipv4;
+    device->port = port;
+}
+
+static void lifx_device_heard(lifx_device_t *device, uint32_t time_now)
+{
+    // coming back online is a change, going offline is noticed when it's asked about
+    if (!(device->flags & LIFX_DEVICE_SEEN) || time_now - device->last_update > LIFX_DEVICE_OFFLINE_MS)
+        LIFX_CHANGED(device);
+    device->flags |= LIFX_DEVICE_SEEN;
+    device->last_update = time_now;
+#ifndef LIFX_NO_QUERY
+    lifx_query_set(device, LIFX_QUERY_ONLINE, true);
+#endif
+}
+
+static void lifx_process_packet(uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port)
+{
+    uint32_t time_now = lifx_get_time_relative();
     lifx_header_t *header = (lifx_header_t *)packet;
-    lifx_flip_header(header);
+    LIFX_CAPTURE(packet, length, false, ipv4, port);
+    LIFX_STATS_ADD(packets_in, 1);
+    LIFX_STATS_ADD(bytes_in, length);
     // sanity check - the size must match that of the one in the header
-    if (length < sizeof(lifx_header_t) || length != header->frame.size)
+    if (length < sizeof(lifx_header_t)) {
+        LIFX_STATS_DROP(LIFX_DROP_SIZE);
+        return;
+    }
+    lifx_flip_header(header);
+    LIFX_STATS_TYPE_ADD(type_packets_in, header->protocol.type, 1);
+    LIFX_STATS_TYPE_ADD(type_bytes_in, header->protocol.type, length);
+    if (length != header->frame.size) {
+        LIFX_STATS_DROP(LIFX_DROP_SIZE);
         return;
+    }
     // service definitions should be treated as new devices
     if (header->protocol.type == LIFX_PT_STATESERVICE) {
         // sanity check the packet size
-        if ((header->frame.size - sizeof(lifx_header_t)) != sizeof(lifx_state_service_t))
+        if ((header->frame.size - sizeof(lifx_header_t)) != LIFX_STATE_SERVICE_SIZE) {
+            LIFX_STATS_DROP(LIFX_DROP_PAYLOAD_SIZE);
             return;
-        lifx_state_service_t *service = (lifx_state_service_t *)(packet + sizeof(lifx_header_t));
+        }
+        lifx_state_service_t service;
+        lifx_decode_state_service(&service, packet + sizeof(lifx_header_t));
         // only accept the UDP service for now
-        if (service->service != 1)
+        if (service.service != 1) {
+            LIFX_STATS_DROP(LIFX_DROP_SERVICE);
+            return;
+        }
+        // a late reply to an earlier discovery would be timed from the wrong send
+        bool answers_discovery = header->address.sequence == last_discover_sequence;
+        // known devices only get their address and liveness refreshed
+        lifx_device_t *device = lifx_get_device_internal(header->address.mac, false);
+        if (device != NULL) {
+            bool stale = !(device->flags & LIFX_DEVICE_SEEN) || time_now - device->last_update > LIFX_REDISCOVER_STALE_MS;
+            lifx_device_info_t *info = lifx_get_device_info(device);
+            lifx_set_device_address(device, ipv4, service.port);
+            lifx_device_heard(device, time_now);
+            // the first measurement is kept, e.g. synchronized commands rely on it staying put
+            if (device->latency < 0 && answers_discovery)
+                device->latency = time_now - last_discover_timestamp;
+            // metadata never arrived, ask for all of it again
+            if (info->product == 0 || (info->version.major == 0 && info->version.minor == 0)) {
+                lifx_poll_system(device);
+            } else {
+                // the device went quiet for a while and may have been updated, check the firmware
+                if (stale)
+                    lifx_send_packet_priority(device, LIFX_PT_GETHOSTFIRMWARE, NULL, 0, LIFX_PRIORITY_BACKGROUND);
+                // the cache doesn't keep colours or power, a light loaded from it is asked for them here
+                if ((device->flags & LIFX_DEVICE_IS_LIGHT) && !(device->flags & LIFX_DEVICE_STATE_KNOWN))
+                    lifx_poll_light(device);
+            }
             return;
-        // create the device object or update if we have one already
-        lifx_device_t *device = lifx_get_device_internal(header->address.mac, true);
-        if (device == NULL)
+        }
+        // otherwise create the device object
+        device = lifx_get_device_internal(header->address.mac, true);
+        if (device == NULL) {
+            LIFX_STATS_DROP(LIFX_DROP_TABLE_FULL);
             return;
-        device->ipv4 = ipv4;
-        device->port = LE(service->port);
-        device->service = service->service;
-        device->first_update = time_now;
-        device->last_update = time_now;
-        device->latency = time_now - last_discover_timestamp;
+        }
+        lifx_set_device_address(device, ipv4, service.port);
+        lifx_device_heard(device, time_now);
+        lifx_get_device_info(device)->service = service.service;
+        lifx_get_device_info(device)->first_update = time_now;
+        device->latency = answers_discovery ? (int32_t)(time_now - last_discover_timestamp) : -1;
         // poll for all the extra info
         lifx_poll_system(device);
         return;
     }
     // check if the source value matches
-    if (header->frame.source != source_value)
+    if (header->frame.source != source_value) {
+        LIFX_STATS_DROP(LIFX_DROP_SOURCE);
         return;
+    }
     // get the handle to the device that's talking to us
     lifx_device_t *device = lifx_get_device_internal(header->address.mac, false);
-    if (device == NULL)
+    if (device == NULL) {
+        LIFX_STATS_DROP(LIFX_DROP_UNKNOWN_DEVICE);
         return;
+    }
     // update the last updated packet
-    device->last_update = time_now;
+    lifx_device_heard(device, time_now);
     // make sure this information is up to date - it might've changed?
-    device->ipv4 = ipv4;
-    device->port = port;
-    // switch case for packet type
-    switch(header->protocol.type) {
-        case LIFX_PT_STATEHOSTFIRMWARE:
-            // sanity check the packet size
-            if ((header->frame.size - sizeof(lifx_header_t)) != sizeof(lifx_state_host_firmware_t))
-                return;
-            lifx_state_host_firmware_t *fw = (lifx_state_host_firmware_t *)(packet + sizeof(lifx_header_t));
-            device->version.build = fw->timestamp;
-            device->version.major = LE16(fw->version_major);
-            device->version.minor = LE16(fw->version_minor);
-            return;
-        case LIFX_PT_STATEVERSION:
-            // sanity check the packet size
-            if ((header->frame.size - sizeof(lifx_header_t)) != sizeof(lifx_state_version_t))
-                return;
-            lifx_state_version_t *ver = (lifx_state_version_t *)(packet + sizeof(lifx_header_t));
-            device->vendor = LE(ver->vendor);
-            device->product = LE(ver->product);
-            device->is_light = lifx_product_is_light(device->product);
-            if (device->is_light)
-                lifx_poll_light(device);
-            else // the light state packet includes the label, for non-lights ask politely
-                lifx_send_packet(device, LIFX_PT_GETLABEL, NULL, 0);
-            return;
-        case LIFX_PT_STATELABEL:
-            // sanity check the packet size
-            if ((header->frame.size - sizeof(lifx_header_t)) != sizeof(lifx_state_label_t))
-                return;
-            lifx_state_label_t *label = (lifx_state_label_t *)(packet + sizeof(lifx_header_t));
-            memcpy(device->label, label->label, 32);
-            return;
-        case LIFX_PT_LIGHTSTATE:
-            // sanity check the packet size
-            if ((header->frame.size - sizeof(lifx_header_t)) != sizeof(lifx_light_state_t))
-                return;
-            lifx_light_state_t *light = (lifx_light_state_t *)(packet + sizeof(lifx_header_t));
-            device->light.kelvin = LE16(light->kelvin);
-            device->light.power = LE16(light->power);
-            device->light.brightness = (double)LE16(light->brightness) / 0xFFFF;
-            device->light.saturation = (double)LE16(light->saturation) / 0xFFFF;
-            device->light.hue = (((double)LE16(light->hue)) * 360) / 0x10000;
-            memcpy(device->label, light->label, 32);
-            return;
-        case LIFX_PT_STATELIGHTPOWER:
-            // sanity check the packet size
-            if ((header->frame.size - sizeof(lifx_header_t)) != sizeof(lifx_state_light_power_t))
-                return;
-            lifx_state_light_power_t *power = (lifx_state_light_power_t *)(packet + sizeof(lifx_header_t));
-            device->light.power = LE16(power->level);
-            return;
+    lifx_set_device_address(device, ipv4, port);
+#ifndef LIFX_NO_LINK
+    lifx_link_received(device, header->address.sequence, header->protocol.type, time_now);
+#endif
+#ifndef LIFX_NO_SCENES
+    lifx_scene_received(device, header->address.sequence, header->protocol.type);
+#endif
+    // LIFX answers a SetColor with the state from before it, which would undo the colour the light is heading to
+    if (header->protocol.type == LIFX_PT_LIGHTSTATE && (device->flags & LIFX_DEVICE_COLOR_SENT) &&
+        lifx_get_device_info(device)->color_sequence == header->address.sequence) {
+        device->flags &= ~LIFX_DEVICE_COLOR_SENT;
+        return;
+    }
+    // and a SetLightPower with the level from before it
+    if (header->protocol.type == LIFX_PT_STATELIGHTPOWER && (device->flags & LIFX_DEVICE_POWER_SENT) &&
+        lifx_get_device_info(device)->power_sequence == header->address.sequence) {
+        device->flags &= ~LIFX_DEVICE_POWER_SENT;
+        return;
+    }
+    // hand it to the message's handler
+    int message = lifx_message_index(header->protocol.type);
+    if (message < 0 || lifx_handlers[message] == NULL) {
+        LIFX_STATS_DROP(LIFX_DROP_UNHANDLED);
+        return;
+    }
+    // every message has a fixed size, sanity check the packet against it
+    if (header->frame.size - sizeof(lifx_header_t) != lifx_message_sizes[message]) {
+        LIFX_STATS_DROP(LIFX_DROP_PAYLOAD_SIZE);
+        return;
+    }
+    lifx_handlers[message](device, packet + sizeof(lifx_header_t));
+}
+
+void lifx_handle_incoming_packet(uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port)
+{
+    lifx_process_packet(packet, length, ipv4, port);
+#ifndef LIFX_NO_REQUESTS
+    // replies are handed over after the device's state has been updated from them
+    lifx_header_t *header = (lifx_header_t *)packet;
+    if (length >= sizeof(lifx_header_t) && header->frame.size == length && header->frame.source == source_value)
+        lifx_complete_request(packet, length);
+#endif
+}
+
+// transitions that have run their course stop counting as changes, the colour stays predicted until the light reports
+static void lifx_expire_transitions(uint32_t time_now)
+{
+    if (transitions_count == 0)
+        return;
+    for (int i = 0; i < devices_count; i++) {
+        lifx_device_t *device = &devices[i];
+        if (!(device->flags & LIFX_DEVICE_TRANSITION))
+            continue;
+        lifx_device_info_t *info = &devices_info[i];
+        if (time_now - info->transition_start >= info->transition_duration) {
+            lifx_end_transition(device);
+            LIFX_CHANGED(device);
+        }
     }
 }
 
+void lifx_tick()
+{
+    uint32_t time_now = lifx_get_time_relative();
+    lifx_expire_transitions(time_now);
+#ifndef LIFX_NO_SEND_QUEUE
+    // in case the caller doesn't say when the transport is writable again
+    lifx_retry_queue();
+#endif
+#ifndef LIFX_NO_SCHEDULE
+    lifx_run_schedule(time_now);
+#endif
+#ifndef LIFX_NO_LINK
+    lifx_run_links(time_now);
+#endif
+#ifndef LIFX_NO_REQUESTS
+    lifx_expire_requests(time_now);
+#endif
+#ifndef LIFX_NO_SCENES
+    lifx_expire_scenes(time_now);
+#endif
+#ifndef LIFX_NO_RECONCILE
+    lifx_run_reconcile(time_now);
+#endif
+#ifndef LIFX_NO_SHM
+    // last, so it sees everything the rest of the tick changed
+    lifx_run_shm(time_now);
+#endif
+}
+
+int32_t lifx_get_next_deadline()
+{
+    uint32_t time_now = lifx_get_time_relative();
+    uint32_t deadline, earliest = 0;
+    bool found = false;
+#ifndef LIFX_NO_SCHEDULE
+    if (lifx_get_schedule_deadline(&deadline)) {
+        earliest = deadline;
+        found = true;
+    }
+#endif
+#ifndef LIFX_NO_REQUESTS
+    if (lifx_get_request_deadline(&deadline) && (!found || LIFX_BEFORE(deadline, earliest))) {
+        earliest = deadline;
+        found = true;
+    }
+#endif
+#ifndef LIFX_NO_LINK
+    if (lifx_get_link_deadline(&deadline) && (!found || LIFX_BEFORE(deadline, earliest))) {
+        earliest = deadline;
+        found = true;
+    }
+#endif
+#ifndef LIFX_NO_SCENES
+    if (lifx_get_scene_deadline(&deadline) && (!found || LIFX_BEFORE(deadline, earliest))) {
+        earliest = deadline;
+        found = true;
+    }
+#endif
+#ifndef LIFX_NO_RECONCILE
+    if (lifx_get_reconcile_deadline(&deadline) && (!found || LIFX_BEFORE(deadline, earliest))) {
+        earliest = deadline;
+        found = true;
+    }
+#endif
+#ifndef LIFX_NO_SHM
+    if (lifx_get_shm_deadline(&deadline) && (!found || LIFX_BEFORE(deadline, earliest))) {
+        earliest = deadline;
+        found = true;
+    }
+#endif
+    if (!found)
+        return -1;
+    // already overdue, tick as soon as possible
+    if (LIFX_BEFORE(earliest, time_now))
+        return 0;
+    return (int32_t)(earliest - time_now);
+}
+
+void lifx_get_stats(lifx_stats_t *out)
+{
+    if (out == NULL)
+        return;
+#ifndef LIFX_NO_STATS
+    memcpy(out, &stats, sizeof(lifx_stats_t));
+#else
+    memset(out, 0, sizeof(lifx_stats_t));
+#endif
+}
+
+void lifx_reset_stats()
+{
+#ifndef LIFX_NO_STATS
+    memset(&stats, 0, sizeof(stats));
+#endif
+}
+
 // -- END CORE LIBRARY FUNCTIONS --
 
 // -- START GENERIC DEVICE INFO --
 
 int lifx_get_device_latency(lifx_device_t *device)
 {
-    if (device == NULL || !device->in_use)
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE))
         return -1;
     return device->latency;
 }
 
 char *lifx_get_device_label(lifx_device_t *device)
 {
-    if (device == NULL || !device->in_use)
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE))
+        return NULL;
+    return lifx_get_device_info(device)->label;
+}
+
+char *lifx_get_device_group(lifx_device_t *device, uint8_t uuid[16])
+{
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE))
         return NULL;
-    return device->label;
+    lifx_section_t *group = &lifx_get_device_info(device)->group;
+    if (uuid != NULL)
+        memcpy(uuid, group->uuid, sizeof(group->uuid));
+    return group->label;
+}
+
+char *lifx_get_device_location(lifx_device_t *device, uint8_t uuid[16])
+{
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE))
+        return NULL;
+    lifx_section_t *location = &lifx_get_device_info(device)->location;
+    if (uuid != NULL)
+        memcpy(uuid, location->uuid, sizeof(location->uuid));
+    return location->label;
 }
 
 uint8_t *lifx_get_device_mac(lifx_device_t *device)
 {
-    if (device == NULL || !device->in_use)
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE))
         return NULL;
     return device->mac;
 }
 
 uint32_t lifx_get_device_ipv4(lifx_device_t *device)
 {
-    if (device == NULL || !device->in_use)
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE))
         return 0xFFFFFFFF; // not really valid, but no real device would have it...
     return device->ipv4;
 }
 
 int lifx_get_device_product(lifx_device_t *device)
 {
-    if (device == NULL || !device->in_use)
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE))
         return -1;
-    return device->product;
+    return lifx_get_device_info(device)->product;
 }
 
 int lifx_get_device_firmware_major(lifx_device_t *device)
 {
-    if (device == NULL || !device->in_use)
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE))
         return -1;
-    return device->version.major;
+    return lifx_get_device_info(device)->version.major;
 }
 
 int lifx_get_device_firmware_minor(lifx_device_t *device)
 {
-    if (device == NULL || !device->in_use)
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE))
         return -1;
-    return device->version.minor;
+    return lifx_get_device_info(device)->version.minor;
 }
 
 // -- END GENERIC DEVICE INFO --
 
 // -- START LIGHT DEVICE FUNCTIONS --
 
+static uint16_t lifx_interpolate(uint16_t from, uint16_t to, uint32_t elapsed, uint32_t duration)
+{
+    return from + (int32_t)(((int64_t)to - from) * elapsed / duration);
+}
+
+// works out where a transition we started should be by now, until the device tells us otherwise
+lifx_hsbk_t lifx_get_predicted_light(lifx_device_t *device)
+{
+    lifx_device_info_t *info;
+    lifx_hsbk_t light;
+    uint32_t elapsed;
+    if (!(device->flags & LIFX_DEVICE_PREDICTED))
+        return device->light;
+    info = lifx_get_device_info(device);
+    elapsed = lifx_get_time_relative() - info->transition_start;
+    if (!(device->flags & LIFX_DEVICE_TRANSITION) || elapsed >= info->transition_duration)
+        return info->transition_to;
+    // hue wraps around, so take the shortest way round the colour wheel
+    light.hue = info->transition_from.hue + (int32_t)(int16_t)(info->transition_to.hue - info->transition_from.hue) *
+        (int64_t)elapsed / info->transition_duration;
+    light.saturation = lifx_interpolate(info->transition_from.saturation, info->transition_to.saturation, elapsed, info->transition_duration);
+    light.brightness = lifx_interpolate(info->transition_from.brightness, info->transition_to.brightness, elapsed, info->transition_duration);
+    light.kelvin = lifx_interpolate(info->transition_from.kelvin, info->transition_to.kelvin, elapsed, info->transition_duration);
+    return light;
+}
+
+#ifndef LIFX_FIXED_POINT
 int lifx_get_light_color(lifx_device_t *device, double *hue, double *saturation, double *brightness, short *kelvin)
 {
-    if (device == NULL || !device->in_use || !device->is_light)
+    lifx_hsbk_t light;
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE) || !(device->flags & LIFX_DEVICE_IS_LIGHT))
         return -1;
+    light = lifx_get_predicted_light(device);
     if (hue != NULL)
-        *hue = device->light.hue;
+        *hue = ((double)light.hue * 360) / 0x10000;
     if (saturation != NULL)
-        *saturation = device->light.saturation;
+        *saturation = (double)light.saturation / 0xFFFF;
     if (brightness != NULL)
-        *brightness = device->light.brightness;
+        *brightness = (double)light.brightness / 0xFFFF;
     if (kelvin != NULL)
-        *kelvin = device->light.kelvin;
+        *kelvin = light.kelvin;
     return 0;
 }
 
 void lifx_set_light_color(lifx_device_t *device, double hue, double saturation, double brightness, short kelvin, uint32_t time)
+{
+    lifx_set_light_hsbk(device, (int)((0x10000 * hue) / 360) % 0x10000, (uint16_t)(saturation * 0xFFFF),
+        (uint16_t)(brightness * 0xFFFF), kelvin, time);
+}
+#endif
+
+int lifx_get_light_hsbk(lifx_device_t *device, uint16_t *hue, uint16_t *saturation, uint16_t *brightness, uint16_t *kelvin)
+{
+    lifx_hsbk_t light;
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE) || !(device->flags & LIFX_DEVICE_IS_LIGHT))
+        return -1;
+    light = lifx_get_predicted_light(device);
+    if (hue != NULL)
+        *hue = light.hue;
+    if (saturation != NULL)
+        *saturation = light.saturation;
+    if (brightness != NULL)
+        *brightness = light.brightness;
+    if (kelvin != NULL)
+        *kelvin = light.kelvin;
+    return 0;
+}
+
+void lifx_set_light_hsbk(lifx_device_t *device, uint16_t hue, uint16_t saturation, uint16_t brightness, uint16_t kelvin, uint32_t time)
+{
+    lifx_send_light_hsbk(device, (lifx_hsbk_t){ hue, saturation, brightness, kelvin }, time);
+}
+
+int lifx_send_light_hsbk(lifx_device_t *device, lifx_hsbk_t color, uint32_t time)
 {
     lifx_set_color_t set_color;
-    if (device == NULL || !device->in_use || !device->is_light)
+    uint8_t payload[LIFX_SET_COLOR_SIZE];
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE) || !(device->flags & LIFX_DEVICE_IS_LIGHT))
+        return -1;
+    set_color.color = color;
+    set_color.duration = time;
+    lifx_encode_set_color(payload, &set_color);
+    // worked out before sending, which moves last_send on
+    lifx_hsbk_t from = lifx_get_predicted_light(device);
+    uint8_t sequence = lifx_send_packet(device, LIFX_PT_SETCOLOR, payload, sizeof(payload));
+#ifndef LIFX_NO_LINK
+    lifx_link_color_sent(device, sequence, set_color.color, time);
+#endif
+    lifx_set_color_sent(device, sequence);
+    // remember where we're heading so the getters don't need to poll to follow along
+    lifx_device_info_t *info = lifx_get_device_info(device);
+    info->transition_from = from;
+    info->transition_to = color;
+    info->transition_start = device->last_send;
+    info->transition_duration = time;
+    if (!(device->flags & LIFX_DEVICE_TRANSITION))
+        transitions_count++;
+    device->flags |= LIFX_DEVICE_TRANSITION | LIFX_DEVICE_PREDICTED;
+    LIFX_CHANGED(device);
+    return sequence;
+}
+
+void lifx_set_color_sent(lifx_device_t *device, uint8_t sequence)
+{
+    lifx_get_device_info(device)->color_sequence = sequence;
+    device->flags |= LIFX_DEVICE_COLOR_SENT;
+}
+
+#ifndef LIFX_FIXED_POINT
+void lifx_set_light_waveform(lifx_device_t *device, lifx_waveform_t waveform, bool transient, double hue, double saturation, double brightness,
+    short kelvin, uint32_t period_ms, float cycles, double skew_ratio, uint8_t set_mask)
+{
+    // skew is sent as a signed value where 0 is an even split between the two colours
+    if (skew_ratio < 0)
+        skew_ratio = 0;
+    if (skew_ratio > 1)
+        skew_ratio = 1;
+    lifx_set_light_waveform_hsbk(device, waveform, transient, (int)((0x10000 * hue) / 360) % 0x10000, (uint16_t)(saturation * 0xFFFF),
+        (uint16_t)(brightness * 0xFFFF), kelvin, period_ms, cycles, (int16_t)(skew_ratio * 0xFFFF - 0x8000), set_mask);
+}
+#endif
+
+void lifx_set_light_waveform_hsbk(lifx_device_t *device, lifx_waveform_t waveform, bool transient, uint16_t hue, uint16_t saturation,
+    uint16_t brightness, uint16_t kelvin, uint32_t period_ms, float cycles, int16_t skew_ratio, uint8_t set_mask)
+{
+    lifx_set_waveform_optional_t set_waveform;
+    uint8_t payload[LIFX_SET_WAVEFORM_OPTIONAL_SIZE];
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE) || !(device->flags & LIFX_DEVICE_IS_LIGHT))
+        return;
+    if ((set_mask & LIFX_WAVEFORM_SET_ALL) == 0)
         return;
-    set_color.hue = LE16((int)((0x10000 * hue) / 360) % 0x10000);
-    set_color.saturation = LE16((uint16_t)(saturation * 0xFFFF));
-    set_color.brightness = LE16((uint16_t)(brightness * 0xFFFF));
-    set_color.kelvin = LE16(kelvin);
-    set_color.time_ms = LE(time);
-    lifx_send_packet(device, LIFX_PT_SETCOLOR, &set_color, sizeof(set_color));
-    return;
+    // waveforms don't follow a straight line, wait for the device to tell us where it ends up
+    if (device->flags & LIFX_DEVICE_TRANSITION)
+        lifx_end_transition(device);
+    if (device->flags & LIFX_DEVICE_PREDICTED)
+        LIFX_CHANGED(device);
+    device->flags &= ~LIFX_DEVICE_PREDICTED;
+    set_waveform.transient = transient;
+    set_waveform.color.hue = hue;
+    set_waveform.color.saturation = saturation;
+    set_waveform.color.brightness = brightness;
+    set_waveform.color.kelvin = kelvin;
+    set_waveform.period = period_ms;
+    set_waveform.cycles = cycles;
+    set_waveform.skew_ratio = skew_ratio;
+    set_waveform.waveform = waveform;
+    set_waveform.set_hue = (set_mask & LIFX_WAVEFORM_SET_HUE) != 0;
+    set_waveform.set_saturation = (set_mask & LIFX_WAVEFORM_SET_SATURATION) != 0;
+    set_waveform.set_brightness = (set_mask & LIFX_WAVEFORM_SET_BRIGHTNESS) != 0;
+    set_waveform.set_kelvin = (set_mask & LIFX_WAVEFORM_SET_KELVIN) != 0;
+    lifx_encode_set_waveform_optional(payload, &set_waveform);
+    // the plain message is the same without the flags on the end, and smaller when every part of the colour is changing
+    static_assert(LIFX_SET_WAVEFORM_SIZE + 4 == LIFX_SET_WAVEFORM_OPTIONAL_SIZE, "waveform messages share a layout");
+    if ((set_mask & LIFX_WAVEFORM_SET_ALL) == LIFX_WAVEFORM_SET_ALL) {
+        lifx_send_packet(device, LIFX_PT_SETWAVEFORM, payload, LIFX_SET_WAVEFORM_SIZE);
+        return;
+    }
+    lifx_send_packet(device, LIFX_PT_SETWAVEFORMOPTIONAL, payload, sizeof(payload));
 }
 
 int lifx_get_light_power(lifx_device_t *device, uint16_t *power)
 {
-    if (device == NULL || !device->in_use || !device->is_light)
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE) || !(device->flags & LIFX_DEVICE_IS_LIGHT))
         return -1;
     if (power != NULL)
-        *power = device->light.power;
+        *power = device->power;
     return 0;
 }
 
 bool lifx_is_light_powered(lifx_device_t *device)
 {
-    if (device == NULL || !device->in_use || !device->is_light || device->light.power != 0xFFFF)
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE) || !(device->flags & LIFX_DEVICE_IS_LIGHT) || device->power != 0xFFFF)
         return false;
     return true;
 }
 
 void lifx_set_light_powered(lifx_device_t *device, bool powered, uint32_t time)
+{
+    lifx_send_light_power(device, powered, time);
+}
+
+int lifx_send_light_power(lifx_device_t *device, bool powered, uint32_t time)
 {
     lifx_set_light_power_t set_power;
-    if (device == NULL || !device->in_use || !device->is_light)
-        return;
-    set_power.power = LE16(powered ? 0xFFFF : 0);
-    set_power.time_ms = LE(time);
-    lifx_send_packet(device, LIFX_PT_SETLIGHTPOWER, &set_power, sizeof(set_power));
-    return;
+    uint8_t payload[LIFX_SET_LIGHT_POWER_SIZE];
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE) || !(device->flags & LIFX_DEVICE_IS_LIGHT))
+        return -1;
+    set_power.level = powered ? 0xFFFF : 0;
+    set_power.duration = time;
+    lifx_encode_set_light_power(payload, &set_power);
+    uint8_t sequence = lifx_send_packet(device, LIFX_PT_SETLIGHTPOWER, payload, sizeof(payload));
+    // the reply won't have the new level, so it's cached now
+    lifx_get_device_info(device)->power_sequence = sequence;
+    device->flags |= LIFX_DEVICE_POWER_SENT;
+    if (device->power != set_power.level)
+        LIFX_CHANGED(device);
+    device->power = set_power.level;
+#ifndef LIFX_NO_QUERY
+    lifx_query_set(device, LIFX_QUERY_POWERED, powered);
+#endif
+    return sequence;
 }
 
 // -- END LIGHT DEVICE FUNCTIONS --
 
+#ifndef LIFX_NO_EFFECTS
+
+// -- START EFFECT FUNCTIONS --
+
+void lifx_set_multizone_effect(lifx_device_t *device, const lifx_effect_t *effect)
+{
+    lifx_set_multi_zone_effect_t set_effect;
+    uint8_t payload[LIFX_SET_MULTI_ZONE_EFFECT_SIZE];
+    if (device == NULL || effect == NULL || !(device->flags & LIFX_DEVICE_IN_USE) || !(device->flags & LIFX_DEVICE_MULTIZONE))
+        return;
+    memset(&set_effect, 0, sizeof(set_effect));
+    set_effect.type = effect->type;
+    set_effect.speed = effect->speed_ms;
+    set_effect.duration = effect->duration_ns;
+    memcpy(set_effect.parameters, effect->parameters, sizeof(set_effect.parameters));
+    lifx_encode_set_multi_zone_effect(payload, &set_effect);
+    lifx_send_packet(device, LIFX_PT_SETMULTIZONEEFFECT, payload, sizeof(payload));
+}
+
+void lifx_set_tile_effect(lifx_device_t *device, const lifx_effect_t *effect)
+{
+    lifx_set_tile_effect_t set_effect;
+    uint8_t payload[LIFX_SET_TILE_EFFECT_SIZE];
+    if (device == NULL || effect == NULL || !(device->flags & LIFX_DEVICE_IN_USE) || !(device->flags & LIFX_DEVICE_MATRIX))
+        return;
+    memset(&set_effect, 0, sizeof(set_effect));
+    set_effect.settings.type = effect->type;
+    set_effect.settings.speed = effect->speed_ms;
+    set_effect.settings.duration = effect->duration_ns;
+    memcpy(set_effect.settings.parameters, effect->parameters, sizeof(set_effect.settings.parameters));
+    set_effect.settings.palette_count = effect->palette_count > LIFX_EFFECT_MAX_PALETTE ? LIFX_EFFECT_MAX_PALETTE : effect->palette_count;
+    memcpy(set_effect.settings.palette, effect->palette, set_effect.settings.palette_count * sizeof(lifx_hsbk_t));
+    lifx_encode_set_tile_effect(payload, &set_effect);
+    lifx_send_packet(device, LIFX_PT_SETTILEEFFECT, payload, sizeof(payload));
+}
+
+void lifx_request_effect(lifx_device_t *device)
+{
+    uint8_t payload[LIFX_GET_TILE_EFFECT_SIZE];
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE))
+        return;
+    if (device->flags & LIFX_DEVICE_MATRIX) {
+        memset(payload, 0, sizeof(payload));
+        lifx_send_packet(device, LIFX_PT_GETTILEEFFECT, payload, sizeof(payload));
+    } else if (device->flags & LIFX_DEVICE_MULTIZONE) {
+        lifx_send_packet(device, LIFX_PT_GETMULTIZONEEFFECT, NULL, 0);
+    }
+}
+
+int lifx_get_device_effect(lifx_device_t *device, lifx_effect_t *effect)
+{
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE) || !(device->flags & LIFX_DEVICE_HAS_EFFECT))
+        return -1;
+    if (effect != NULL)
+        memcpy(effect, &lifx_get_device_info(device)->effect, sizeof(lifx_effect_t));
+    return 0;
+}
+
+// -- END EFFECT FUNCTIONS --
+
+#endif // LIFX_NO_EFFECTS
+
 // -- START PRODUCT DETAILS --
 
-char *lifx_get_product_name(int product_id)
+static const lifx_product_info_t *lifx_get_product_info(int product_id)
 {
     for (int i = 0; i < lifx_products_count; i++) {
-        lifx_product_info_t product = lifx_products[i];
-        if (product.id == product_id)
-            return product.product_name;
+        if (lifx_products[i].id == product_id)
+            return &lifx_products[i];
     }
+    return NULL;
+}
+
+char *lifx_get_product_name(int product_id)
+{
+#ifndef LIFX_NO_PRODUCT_NAMES
+    const lifx_product_info_t *product = lifx_get_product_info(product_id);
+    if (product != NULL)
+        return product->product_name;
+#endif
     return "Unknown Product";
 }
 
 bool lifx_product_is_light(int product_id)
 {
-    for (int i = 0; i < lifx_products_count; i++) {
-        lifx_product_info_t product = lifx_products[i];
-        if (product.id == product_id)
-            return !product.relays; // TODO: do we have a better way of knowing this?
-    }
+    const lifx_product_info_t *product = lifx_get_product_info(product_id);
+    if (product != NULL)
+        return !product->relays; // TODO: do we have a better way of knowing this?
     return false;
 }
 
+#define LIFX_KELVIN_MIN 1500 // widest range of whites any light has, for products not in the table
+#define LIFX_KELVIN_MAX 9000
+#define LIFX_COLOR_TOLERANCE 64 // hue, saturation and brightness this close together are the same to the firmware
+#define LIFX_KELVIN_TOLERANCE 25
+
+// a light keeps its kelvin within what it can show, so that's where one outside it ends up
+static uint16_t lifx_clamp_kelvin(lifx_device_t *device, uint16_t kelvin)
+{
+    uint16_t min = LIFX_KELVIN_MIN, max = LIFX_KELVIN_MAX;
+#ifndef LIFX_COMPACT_PRODUCTS
+    const lifx_product_info_t *product = lifx_get_product_info(lifx_get_device_info(device)->product);
+    if (product != NULL && product->temp_min != 0) {
+        min = product->temp_min;
+        max = product->temp_max;
+    }
+#endif
+    return kelvin < min ? min : kelvin > max ? max : kelvin;
+}
+
+static bool lifx_near(uint16_t a, uint16_t b, uint16_t tolerance)
+{
+    return (a > b ? a - b : b - a) <= tolerance;
+}
+
+bool lifx_color_matches(lifx_device_t *device, lifx_hsbk_t a, lifx_hsbk_t b)
+{
+    if (!lifx_near(a.brightness, b.brightness, LIFX_COLOR_TOLERANCE) ||
+        !lifx_near(lifx_clamp_kelvin(device, a.kelvin), lifx_clamp_kelvin(device, b.kelvin), LIFX_KELVIN_TOLERANCE))
+        return false;
+    // white lights only have brightness and kelvin, and an unsaturated colour has no hue to speak of
+    if (!(device->flags & LIFX_DEVICE_COLOR))
+        return true;
+    if (!lifx_near(a.saturation, b.saturation, LIFX_COLOR_TOLERANCE))
+        return false;
+    // hue goes round, 65535 is next to 0
+    uint16_t hue_difference = a.hue - b.hue;
+    return b.saturation == 0 || hue_difference <= LIFX_COLOR_TOLERANCE || hue_difference >= (uint16_t)-LIFX_COLOR_TOLERANCE;
+}
+
+void lifx_set_device_product(lifx_device_t *device, uint32_t product_id)
+{
+    const lifx_product_info_t *product = lifx_get_product_info(product_id);
+    if (lifx_get_device_info(device)->product != product_id)
+        LIFX_CHANGED(device);
+    lifx_get_device_info(device)->product = product_id;
+    device->flags &= ~(LIFX_DEVICE_IS_LIGHT | LIFX_DEVICE_MULTIZONE | LIFX_DEVICE_MATRIX | LIFX_DEVICE_COLOR);
+#ifndef LIFX_NO_QUERY
+    lifx_query_set(device, LIFX_QUERY_LIGHT | LIFX_QUERY_COLOR | LIFX_QUERY_MULTIZONE | LIFX_QUERY_MATRIX | LIFX_QUERY_HEV, false);
+    if (product != NULL) {
+        lifx_query_set(device, LIFX_QUERY_LIGHT, !product->relays);
+        lifx_query_set(device, LIFX_QUERY_COLOR, product->color);
+        lifx_query_set(device, LIFX_QUERY_MULTIZONE, product->multizone);
+        lifx_query_set(device, LIFX_QUERY_MATRIX, product->matrix);
+        lifx_query_set(device, LIFX_QUERY_HEV, product->hev);
+    }
+#endif
+    if (product == NULL)
+        return;
+    if (!product->relays) // TODO: do we have a better way of knowing this?
+        device->flags |= LIFX_DEVICE_IS_LIGHT;
+    if (product->multizone)
+        device->flags |= LIFX_DEVICE_MULTIZONE;
+    if (product->matrix)
+        device->flags |= LIFX_DEVICE_MATRIX;
+    if (product->color)
+        device->flags |= LIFX_DEVICE_COLOR;
+}
+
 // -- END PRODUCT DETAILS --
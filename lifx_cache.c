@@ -0,0 +1,193 @@
+/*
+    liblifx - lifx_cache.c
+    Saving and loading the device table to a file, for warm startup.
+*/
+
+#include <lifx_config.h>
+#ifndef LIFX_NO_STDIO
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "lifx_internal.h"
+#include "lifx_protocol.h"
+#include <lifx.h>
+
+// The cache file is a header followed by fixed-size little endian records,
+// so it can be memory-mapped and read in place.
+#define LIFX_CACHE_MAGIC 0x4344584C // 'LXDC'
+#define LIFX_CACHE_VERSION 1
+
+typedef struct _lifx_cache_header_t
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t count;
+    uint32_t reserved;
+} PACKED lifx_cache_header_t;
+static_assert(sizeof(lifx_cache_header_t) == 16, "cache header size");
+
+typedef struct _lifx_cache_section_t
+{
+    uint8_t uuid[16];
+    uint64_t timestamp;
+    char label[32];
+} PACKED lifx_cache_section_t;
+
+typedef struct _lifx_cache_record_t
+{
+    uint8_t mac[6];
+    uint16_t port;
+    uint32_t ipv4;
+    uint32_t vendor;
+    uint32_t product;
+    uint64_t firmware_build;
+    uint16_t firmware_major;
+    uint16_t firmware_minor;
+    char label[32];
+    lifx_cache_section_t group;
+    lifx_cache_section_t location;
+} PACKED lifx_cache_record_t;
+static_assert(sizeof(lifx_cache_record_t) == 176, "cache record size");
+
+static void lifx_cache_save_section(lifx_cache_section_t *out, lifx_section_t *section)
+{
+    memcpy(out->uuid, section->uuid, sizeof(out->uuid));
+    out->timestamp = LE64(section->timestamp);
+    memcpy(out->label, section->label, sizeof(out->label));
+}
+
+static void lifx_cache_load_section(lifx_section_t *section, const lifx_cache_section_t *in)
+{
+    memcpy(section->uuid, in->uuid, sizeof(section->uuid));
+    section->timestamp = LE64(in->timestamp);
+    memcpy(section->label, in->label, sizeof(section->label));
+    section->terminator = 0;
+}
+
+int lifx_save_device_cache(const char *path)
+{
+    char temp_path[1024];
+    lifx_cache_header_t header;
+    lifx_cache_record_t record;
+    int count = 0;
+    // write to a temporary file first so a crash never leaves a torn cache behind
+    if (snprintf(temp_path, sizeof(temp_path), "%s.tmp", path) >= sizeof(temp_path))
+        return -1;
+    FILE *fp = fopen(temp_path, "wb");
+    if (fp == NULL)
+        return -1;
+    memset(&header, 0, sizeof(header));
+    if (fwrite(&header, sizeof(header), 1, fp) != 1)
+        goto fail;
+    for (int i = 0; i < lifx_get_device_count(); i++) {
+        lifx_device_t *device = lifx_get_device_from_num(i);
+        if (device == NULL)
+            continue;
+        lifx_device_info_t *info = lifx_get_device_info(device);
+        // devices we've never fully identified aren't worth keeping
+        if (info->product == 0)
+            continue;
+        memset(&record, 0, sizeof(record));
+        memcpy(record.mac, device->mac, 6);
+        record.port = LE16(device->port);
+        record.ipv4 = LE(device->ipv4);
+        record.vendor = LE(info->vendor);
+        record.product = LE(info->product);
+        record.firmware_build = LE64(info->version.build);
+        record.firmware_major = LE16(info->version.major);
+        record.firmware_minor = LE16(info->version.minor);
+        memcpy(record.label, info->label, sizeof(record.label));
+        lifx_cache_save_section(&record.group, &info->group);
+        lifx_cache_save_section(&record.location, &info->location);
+        if (fwrite(&record, sizeof(record), 1, fp) != 1)
+            goto fail;
+        count++;
+    }
+    // go back and fill in the header now we know how many records there are
+    header.magic = LE(LIFX_CACHE_MAGIC);
+    header.version = LE16(LIFX_CACHE_VERSION);
+    header.record_size = LE16(sizeof(lifx_cache_record_t));
+    header.count = LE(count);
+    if (fseek(fp, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, fp) != 1)
+        goto fail;
+    if (fclose(fp) != 0) {
+        remove(temp_path);
+        return -1;
+    }
+    if (rename(temp_path, path) != 0) {
+        remove(temp_path);
+        return -1;
+    }
+    return count;
+fail:
+    fclose(fp);
+    remove(temp_path);
+    return -1;
+}
+
+int lifx_load_device_cache(const char *path)
+{
+    struct stat st;
+    int count = 0;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    if (fstat(fd, &st) != 0 || st.st_size < sizeof(lifx_cache_header_t)) {
+        close(fd);
+        return -1;
+    }
+    uint8_t *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return -1;
+    const lifx_cache_header_t *header = (const lifx_cache_header_t *)map;
+    uint32_t records = LE(header->count);
+    // sanity check the header against the size of the file
+    if (LE(header->magic) != LIFX_CACHE_MAGIC || LE16(header->version) != LIFX_CACHE_VERSION ||
+        LE16(header->record_size) != sizeof(lifx_cache_record_t) ||
+        records > (st.st_size - sizeof(lifx_cache_header_t)) / sizeof(lifx_cache_record_t)) {
+        munmap(map, st.st_size);
+        return -1;
+    }
+    const lifx_cache_record_t *record = (const lifx_cache_record_t *)(map + sizeof(lifx_cache_header_t));
+    for (uint32_t i = 0; i < records; i++, record++) {
+        uint8_t mac[6];
+        memcpy(mac, record->mac, 6);
+        lifx_device_t *device = lifx_get_device_internal(mac, true);
+        if (device == NULL)
+            break;
+        // anything we've heard from this session is fresher than the cache
+        if (device->flags & LIFX_DEVICE_SEEN)
+            continue;
+        lifx_device_info_t *info = lifx_get_device_info(device);
+        device->ipv4 = LE(record->ipv4);
+        device->port = LE16(record->port);
+        info->service = 1;
+        info->vendor = LE(record->vendor);
+        lifx_set_device_product(device, LE(record->product));
+        info->version.build = LE64(record->firmware_build);
+        info->version.major = LE16(record->firmware_major);
+        info->version.minor = LE16(record->firmware_minor);
+        memcpy(info->label, record->label, sizeof(info->label));
+        info->terminator = 0;
+        lifx_cache_load_section(&info->group, &record->group);
+        lifx_cache_load_section(&info->location, &record->location);
+#ifndef LIFX_NO_QUERY
+        lifx_query_set_group(device, info->group.uuid);
+        lifx_query_set_location(device, info->location.uuid);
+#endif
+        // no latency measurement until the device answers a discovery
+        device->latency = -1;
+        count++;
+    }
+    munmap(map, st.st_size);
+    return count;
+}
+
+#endif // LIFX_NO_STDIO
@@ -0,0 +1,263 @@
+/*
+    liblifx - lifx_capture.c
+    Opt-in capture of the library's traffic to a pcap file.
+*/
+
+#include <lifx_config.h>
+#ifndef LIFX_NO_STDIO
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#include "lifx_internal.h"
+#include <lifx.h>
+
+// Packets are copied into a single-producer ring by the thread using the library,
+// and a writer thread drains the ring into the file so the hot path never touches disk.
+#define LIFX_CAPTURE_RING_SLOTS 1024 // must be a power of two
+#define LIFX_CAPTURE_IDLE_NS 10000000 // writer thread sleeps for 10ms when the ring is empty
+
+#define PCAP_MAGIC 0xA1B2C3D4
+#define PCAP_LINKTYPE_IPV4 228
+#define PCAP_IPV4_HEADER_SIZE 20
+#define PCAP_UDP_HEADER_SIZE 8
+
+typedef struct _lifx_capture_slot_t
+{
+    uint32_t ts_sec;
+    uint32_t ts_usec;
+    uint32_t src_ipv4;
+    uint32_t dst_ipv4;
+    uint16_t src_port;
+    uint16_t dst_port;
+    uint16_t length;
+    uint8_t data[LIFX_MAX_PACKET_SIZE];
+} lifx_capture_slot_t;
+
+typedef struct _pcap_file_header_t
+{
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t linktype;
+} pcap_file_header_t;
+
+typedef struct _pcap_record_header_t
+{
+    uint32_t ts_sec;
+    uint32_t ts_usec;
+    uint32_t incl_len;
+    uint32_t orig_len;
+} pcap_record_header_t;
+
+atomic_bool lifx_capture_active = false;
+
+static lifx_capture_slot_t *capture_ring = NULL; // only allocated while capturing
+static atomic_uint capture_head = 0; // next slot the producer writes
+static atomic_uint capture_tail = 0; // next slot the writer reads
+static atomic_bool capture_running = false;
+static atomic_ullong capture_dropped = 0;
+static atomic_ullong capture_written = 0;
+static atomic_ullong capture_failed = 0; // packets the file wouldn't take
+static atomic_uint capture_producers = 0; // threads part way through lifx_capture_packet
+static uint16_t capture_ip_id = 0;
+static uint32_t capture_local_ipv4 = 0;
+static uint16_t capture_local_port = 0;
+static FILE *capture_file = NULL;
+static pthread_t capture_thread;
+
+void lifx_capture_packet(const uint8_t *packet, size_t length, bool outgoing, uint32_t ipv4, uint16_t port)
+{
+    // counted in before checking again, lifx_capture_stop waits for this to drop back to zero before freeing the ring
+    atomic_fetch_add(&capture_producers, 1);
+    if (!atomic_load(&lifx_capture_active)) {
+        atomic_fetch_sub_explicit(&capture_producers, 1, memory_order_release);
+        return;
+    }
+    unsigned int head = atomic_load_explicit(&capture_head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&capture_tail, memory_order_acquire);
+    if (head - tail >= LIFX_CAPTURE_RING_SLOTS || length > LIFX_MAX_PACKET_SIZE) {
+        atomic_fetch_add_explicit(&capture_dropped, 1, memory_order_relaxed);
+        atomic_fetch_sub_explicit(&capture_producers, 1, memory_order_release);
+        return;
+    }
+    struct timespec ts;
+    lifx_capture_slot_t *slot = &capture_ring[head & (LIFX_CAPTURE_RING_SLOTS - 1)];
+    clock_gettime(CLOCK_REALTIME, &ts);
+    slot->ts_sec = ts.tv_sec;
+    slot->ts_usec = ts.tv_nsec / 1000;
+    if (outgoing) {
+        slot->src_ipv4 = capture_local_ipv4;
+        slot->src_port = capture_local_port;
+        slot->dst_ipv4 = ipv4;
+        slot->dst_port = port;
+    } else {
+        slot->src_ipv4 = ipv4;
+        slot->src_port = port;
+        slot->dst_ipv4 = capture_local_ipv4;
+        slot->dst_port = capture_local_port;
+    }
+    slot->length = length;
+    memcpy(slot->data, packet, length);
+    atomic_store_explicit(&capture_head, head + 1, memory_order_release);
+    atomic_fetch_sub_explicit(&capture_producers, 1, memory_order_release);
+}
+
+static void lifx_capture_put16(uint8_t *out, uint16_t value)
+{
+    out[0] = value >> 8;
+    out[1] = value & 0xFF;
+}
+
+static void lifx_capture_put32(uint8_t *out, uint32_t value)
+{
+    lifx_capture_put16(out, value >> 16);
+    lifx_capture_put16(out + 2, value & 0xFFFF);
+}
+
+// synthesizes the IPv4 and UDP headers the datagram would've had on the wire
+static void lifx_capture_write_slot(lifx_capture_slot_t *slot)
+{
+    uint8_t headers[PCAP_IPV4_HEADER_SIZE + PCAP_UDP_HEADER_SIZE];
+    pcap_record_header_t record;
+    uint32_t checksum = 0;
+    uint16_t total_length = sizeof(headers) + slot->length;
+
+    memset(headers, 0, sizeof(headers));
+    headers[0] = 0x45; // IPv4, 20 byte header
+    lifx_capture_put16(headers + 2, total_length);
+    lifx_capture_put16(headers + 4, capture_ip_id++);
+    lifx_capture_put16(headers + 6, 0x4000); // don't fragment
+    headers[8] = 64; // TTL
+    headers[9] = 17; // UDP
+    lifx_capture_put32(headers + 12, slot->src_ipv4);
+    lifx_capture_put32(headers + 16, slot->dst_ipv4);
+    for (int i = 0; i < PCAP_IPV4_HEADER_SIZE; i += 2)
+        checksum += (headers[i] << 8) | headers[i + 1];
+    while (checksum >> 16)
+        checksum = (checksum & 0xFFFF) + (checksum >> 16);
+    lifx_capture_put16(headers + 10, ~checksum & 0xFFFF);
+    // UDP checksum is optional over IPv4, leave it as zero
+    lifx_capture_put16(headers + 20, slot->src_port);
+    lifx_capture_put16(headers + 22, slot->dst_port);
+    lifx_capture_put16(headers + 24, PCAP_UDP_HEADER_SIZE + slot->length);
+
+    record.ts_sec = slot->ts_sec;
+    record.ts_usec = slot->ts_usec;
+    record.incl_len = total_length;
+    record.orig_len = total_length;
+    if (fwrite(&record, sizeof(record), 1, capture_file) != 1 || fwrite(headers, sizeof(headers), 1, capture_file) != 1 ||
+        fwrite(slot->data, slot->length, 1, capture_file) != 1) {
+        atomic_fetch_add_explicit(&capture_failed, 1, memory_order_relaxed);
+        return;
+    }
+    atomic_fetch_add_explicit(&capture_written, 1, memory_order_relaxed);
+}
+
+static int lifx_capture_drain()
+{
+    int count = 0;
+    unsigned int tail = atomic_load_explicit(&capture_tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&capture_head, memory_order_acquire);
+    while (tail != head) {
+        lifx_capture_write_slot(&capture_ring[tail & (LIFX_CAPTURE_RING_SLOTS - 1)]);
+        tail++;
+        count++;
+        atomic_store_explicit(&capture_tail, tail, memory_order_release);
+    }
+    return count;
+}
+
+static void *lifx_capture_writer(void *arg)
+{
+    struct timespec idle = { 0, LIFX_CAPTURE_IDLE_NS };
+    while (atomic_load(&capture_running)) {
+        if (lifx_capture_drain() == 0) {
+            fflush(capture_file);
+            nanosleep(&idle, NULL);
+        }
+    }
+    return NULL;
+}
+
+int lifx_capture_start(const char *path, uint32_t local_ipv4, uint16_t local_port)
+{
+    pcap_file_header_t header;
+    if (capture_file != NULL)
+        return -1;
+    capture_ring = malloc(sizeof(lifx_capture_slot_t) * LIFX_CAPTURE_RING_SLOTS);
+    if (capture_ring == NULL)
+        return -1;
+    capture_file = fopen(path, "wb");
+    if (capture_file == NULL)
+        goto fail;
+    // written in host order, readers work out the byte order from the magic
+    header.magic = PCAP_MAGIC;
+    header.version_major = 2;
+    header.version_minor = 4;
+    header.thiszone = 0;
+    header.sigfigs = 0;
+    header.snaplen = 0xFFFF;
+    header.linktype = PCAP_LINKTYPE_IPV4;
+    if (fwrite(&header, sizeof(header), 1, capture_file) != 1)
+        goto fail;
+    capture_local_ipv4 = local_ipv4;
+    capture_local_port = local_port;
+    atomic_store(&capture_written, 0);
+    atomic_store(&capture_dropped, 0);
+    atomic_store(&capture_failed, 0);
+    atomic_store(&capture_head, 0);
+    atomic_store(&capture_tail, 0);
+    atomic_store(&capture_running, true);
+    if (pthread_create(&capture_thread, NULL, lifx_capture_writer, NULL) != 0) {
+        atomic_store(&capture_running, false);
+        goto fail;
+    }
+    atomic_store_explicit(&lifx_capture_active, true, memory_order_release);
+    return 0;
+fail:
+    if (capture_file != NULL)
+        fclose(capture_file);
+    capture_file = NULL;
+    free(capture_ring);
+    capture_ring = NULL;
+    return -1;
+}
+
+void lifx_capture_stop()
+{
+    if (capture_file == NULL)
+        return;
+    atomic_store(&lifx_capture_active, false);
+    // a thread that saw capture was on may still be copying a packet into the ring
+    while (atomic_load_explicit(&capture_producers, memory_order_acquire) != 0)
+        sched_yield();
+    atomic_store(&capture_running, false);
+    pthread_join(capture_thread, NULL);
+    // anything still in the ring was captured before we stopped, so write it out
+    lifx_capture_drain();
+    fclose(capture_file);
+    capture_file = NULL;
+    free(capture_ring);
+    capture_ring = NULL;
+}
+
+void lifx_capture_get_counts(uint64_t *written, uint64_t *dropped, uint64_t *failed)
+{
+    if (written != NULL)
+        *written = atomic_load(&capture_written);
+    if (dropped != NULL)
+        *dropped = atomic_load(&capture_dropped);
+    if (failed != NULL)
+        *failed = atomic_load(&capture_failed);
+}
+
+#endif // LIFX_NO_STDIO
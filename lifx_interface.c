@@ -0,0 +1,101 @@
+/*
+    liblifx - lifx_interface.c
+    The local network interfaces discovery broadcasts on, and which one each device was found on.
+*/
+
+#include <string.h>
+#include <lifx_config.h>
+#ifndef LIFX_NO_INTERFACES
+
+#ifndef LIFX_NO_IFADDRS
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+#include "lifx_internal.h"
+#include <lifx.h>
+
+static lifx_interface_t interfaces[LIFX_MAX_INTERFACES];
+static int interfaces_count = 0;
+
+void lifx_reset_interfaces()
+{
+    memset(interfaces, 0, sizeof(interfaces));
+    interfaces_count = 0;
+}
+
+int lifx_add_interface(uint32_t ipv4, uint32_t netmask)
+{
+    // point to point links (/31 and /32) have no broadcast address
+    if (ipv4 == 0 || (~netmask & 0xFFFFFFFE) == 0)
+        return -1;
+    for (int i = 0; i < interfaces_count; i++) {
+        if (interfaces[i].ipv4 == ipv4 && interfaces[i].netmask == netmask)
+            return i;
+    }
+    if (interfaces_count >= LIFX_MAX_INTERFACES)
+        return -1;
+    lifx_interface_t *interface = &interfaces[interfaces_count];
+    interface->ipv4 = ipv4;
+    interface->netmask = netmask;
+    interface->broadcast = ipv4 | ~netmask;
+    return interfaces_count++;
+}
+
+#ifndef LIFX_NO_IFADDRS
+int lifx_scan_interfaces()
+{
+    struct ifaddrs *addresses;
+    int added = 0;
+    if (getifaddrs(&addresses) != 0)
+        return -1;
+    for (struct ifaddrs *address = addresses; address != NULL; address = address->ifa_next) {
+        if (address->ifa_addr == NULL || address->ifa_netmask == NULL || address->ifa_addr->sa_family != AF_INET)
+            continue;
+        // devices are never found on the loopback, and an interface that's down can't send anything
+        if (!(address->ifa_flags & IFF_UP) || !(address->ifa_flags & IFF_BROADCAST) || (address->ifa_flags & IFF_LOOPBACK))
+            continue;
+        uint32_t ipv4 = ntohl(((struct sockaddr_in *)address->ifa_addr)->sin_addr.s_addr);
+        uint32_t netmask = ntohl(((struct sockaddr_in *)address->ifa_netmask)->sin_addr.s_addr);
+        int before = interfaces_count;
+        if (lifx_add_interface(ipv4, netmask) == before)
+            added++;
+    }
+    freeifaddrs(addresses);
+    return added;
+}
+#endif
+
+int lifx_get_interface_count()
+{
+    return interfaces_count;
+}
+
+int lifx_get_interface(int index, lifx_interface_t *interface)
+{
+    if (index < 0 || index >= interfaces_count)
+        return -1;
+    if (interface != NULL)
+        memcpy(interface, &interfaces[index], sizeof(lifx_interface_t));
+    return 0;
+}
+
+int lifx_find_interface(uint32_t ipv4)
+{
+    for (int i = 0; i < interfaces_count; i++) {
+        if ((ipv4 & interfaces[i].netmask) == (interfaces[i].ipv4 & interfaces[i].netmask))
+            return i;
+    }
+    return -1;
+}
+
+int lifx_get_device_interface(lifx_device_t *device)
+{
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE))
+        return -1;
+    return device->interface;
+}
+
+#endif // LIFX_NO_INTERFACES
@@ -2,18 +2,28 @@
 #define LIFX_INTERNAL_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <lifx_config.h>
+#include <lifx.h>
+#ifndef LIFX_NO_STDIO
+#include <stdatomic.h>
+#endif
 
 #ifdef LIFX_BIG_ENDIAN
-#define LE16(i) (((((i) & 0xFF) << 8) | (((i) >> 8) & 0xFF)) & 0xFFFF)
-#define LE(i)   (((i & 0xff000000) >> 24) | ((i & 0x00ff0000) >> 8) | ((i & 0x0000ff00) << 8) | (i << 24))
+#define LE16(i) __builtin_bswap16(i)
+#define LE(i)   __builtin_bswap32(i)
+#define LE64(i) __builtin_bswap64(i)
 #else
 #define LE16(i) (i)
 #define LE(i)   (i)
+#define LE64(i) (i)
 #endif
 
-#define LIFX_MAX_DEVICE_COUNT 16
 #define LIFX_BROADCAST_IPV4 0xFFFFFFFF // 255.255.255.255
 #define LIFX_BROADCAST_PORT 56700
+#define LIFX_DEVICE_OFFLINE_MS 30000 // devices silent for longer than this are counted as offline
+#define LIFX_REDISCOVER_STALE_MS 60000 // known devices silent for longer than this get their firmware re-checked
 
 typedef struct _lifx_version_t
 {
@@ -30,38 +40,232 @@ typedef struct _lifx_section_t
     char terminator;
 } lifx_section_t;
 
-typedef struct _lifx_device_light_t
-{
-    double hue;
-    double saturation;
-    double brightness;
-    short kelvin;
-    uint16_t power;
-} lifx_device_light_t;
+#define LIFX_DEVICE_IN_USE     (1 << 0)
+#define LIFX_DEVICE_IS_LIGHT   (1 << 1)
+#define LIFX_DEVICE_SEEN       (1 << 2) // a packet has been recieved from the device since lifx_init
+#define LIFX_DEVICE_MULTIZONE  (1 << 3)
+#define LIFX_DEVICE_MATRIX     (1 << 4)
+#define LIFX_DEVICE_HAS_EFFECT (1 << 5) // the device has reported the effect it's running
+#define LIFX_DEVICE_TRANSITION (1 << 6) // a colour transition we asked for is still running
+#define LIFX_DEVICE_COLOR      (1 << 7) // can show colours, not just whites
+#define LIFX_DEVICE_PREDICTED  (1 << 8) // the colour is where a transition we asked for gets to, the light hasn't reported since
+#define LIFX_DEVICE_COLOR_SENT (1 << 9) // a SetColor is waiting for its reply, which shows the light from before it
+#define LIFX_DEVICE_STATE_KNOWN (1 << 10) // the light has reported its colour and power since lifx_init
+#define LIFX_DEVICE_POWER_SENT (1 << 11) // a SetLightPower is waiting for its reply, which has the level from before it
 
+// Fields touched by every packet, kept small enough to fit a single cache line.
+// Times are milliseconds since lifx_init, compare them by subtracting.
 typedef struct _lifx_device_t
 {
-    bool in_use;
-    // device metadata
     uint8_t mac[6]; // MAC from packet address
-    uint32_t ipv4; // IPv4 of device (in host order)
     uint16_t port; // port of service (in host order)
+    uint32_t ipv4; // IPv4 of device (in host order)
+    uint32_t last_send; // time of the last sent packet
+    uint32_t last_update; // time of the last recieved packet
+    int32_t latency; // milliseconds from discovery to detection
+    uint16_t flags; // LIFX_DEVICE_* bits
+    uint16_t power; // light power level
+    lifx_hsbk_t light; // light colour
+#ifndef LIFX_NO_INTERFACES
+    int8_t interface; // interface the device was found on, -1 if none match
+#endif
+} __attribute__((aligned(LIFX_DEVICE_ALIGN))) lifx_device_t;
+
+#ifndef LIFX_NO_LINK
+// a packet sent to a device that we're waiting to hear back about
+typedef struct _lifx_link_probe_t
+{
+    uint32_t sent; // time it was sent
+    uint8_t sequence; // sequence number it was sent with, a reply of the expected type carrying it confirms it
+    bool waiting; // no reply has arrived yet
+} lifx_link_probe_t;
+
+// How well a device's Wi-Fi link is doing, worked out from the signal it reports and how many
+// of the packets we track get a reply.
+typedef struct _lifx_link_t
+{
+    float signal; // last reported signal in mW, 0 until the device has said
+    uint16_t rtt; // smoothed round trip in ms, 0 until measured
+    uint8_t loss; // smoothed share of tracked packets that went unanswered, out of 255
+    uint8_t retries_left; // resends left for the colour being confirmed
+    uint32_t next_poll; // time to next ask for the Wi-Fi info
+    uint32_t next_frame; // earliest time the next streamed frame may be sent
+    lifx_link_probe_t poll; // the last GetWifiInfo
+    lifx_link_probe_t color; // the last colour set, resent until the device confirms it
+    uint32_t color_start; // time the colour was first sent, resends only get what's left of the transition
+    uint32_t color_duration;
+    lifx_hsbk_t color_value;
+    lifx_hsbk_t frame; // newest streamed frame, waiting for next_frame
+    uint32_t frame_duration;
+    bool frame_pending;
+} lifx_link_t;
+#endif
+
+// Fields that rarely change, stored in a separate array at the same index as the device.
+typedef struct _lifx_device_info_t
+{
     uint8_t service; // service number (always 1, for UDP)
     uint32_t vendor; // vendor number of device from GetVersion
     uint32_t product; // product number of device from GetVersion
+    uint32_t first_update; // time of the first packet
     lifx_version_t version; // firmware version from GetHostFirmware
     lifx_section_t group; // data from GetGroup
     lifx_section_t location; // data from GetLocation
     char label[32]; // device label
     char terminator; // always 0, terminates label
-    // update information
-    int latency; // milliseconds from discovery to detection
-    uint64_t first_update; // unix timestamp, in milliseconds, of the first packet
-    uint64_t last_send; // unix timestamp, in milliseconds, of the last sent packet
-    uint64_t last_update; // unix timestamp, in milliseconds, of the last recieved packet
-    // type-specific information
-    bool is_light;
-    lifx_device_light_t light;
-} lifx_device_t;
+    lifx_hsbk_t transition_from; // colour at the start of the running transition
+    lifx_hsbk_t transition_to; // colour the running transition ends on
+    uint32_t transition_start; // time the running transition started
+    uint32_t transition_duration; // length of the running transition in milliseconds
+    uint8_t color_sequence; // sequence number of the SetColor waiting for its reply
+    uint8_t power_sequence; // sequence number of the SetLightPower waiting for its reply
+#ifndef LIFX_NO_EFFECTS
+    lifx_effect_t effect; // last effect reported by the device
+#endif
+#ifndef LIFX_NO_LINK
+    lifx_link_t link; // Wi-Fi quality and the send budget that follows from it
+#endif
+} lifx_device_info_t;
+
+// shared between the library's source files
+lifx_device_t *lifx_get_device_internal(uint8_t mac[6], bool create);
+lifx_device_t *lifx_get_devices();
+lifx_device_info_t *lifx_get_device_info(lifx_device_t *device);
+void lifx_set_device_product(lifx_device_t *device, uint32_t product_id);
+// whether a light showing one colour is close enough to another, with the kelvin kept within what the light can show
+// and hue, saturation and brightness allowed to be off by the firmware's rounding
+bool lifx_color_matches(lifx_device_t *device, lifx_hsbk_t a, lifx_hsbk_t b);
+uint32_t lifx_get_time_relative();
+// times are compared by subtracting, so they can wrap
+#define LIFX_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
+// the colour a light is at, or has got to in a transition we started
+lifx_hsbk_t lifx_get_predicted_light(lifx_device_t *device);
+// remembers the sequence number a SetColor went out with, so the state it's answered with isn't taken as the new colour
+void lifx_set_color_sent(lifx_device_t *device, uint8_t sequence);
+// every packet's sequence number comes from here, so a reply only ever matches the one packet it answers
+uint8_t lifx_next_sequence();
+// sends with LIFX_PRIORITY_INTERACTIVE, returns the sequence number the packet was sent with
+uint8_t lifx_send_packet(lifx_device_t *target_device, uint16_t packet_type, void *extra_data, size_t extra_size);
+uint8_t lifx_send_packet_priority(lifx_device_t *target_device, uint16_t packet_type, void *extra_data, size_t extra_size,
+    lifx_priority_t priority);
+void lifx_send_packet_sequence(lifx_device_t *target_device, uint16_t packet_type, void *extra_data, size_t extra_size, uint8_t sequence,
+    lifx_priority_t priority);
+// as lifx_set_light_hsbk and lifx_set_light_powered, returning the sequence number sent or -1 if nothing was
+int lifx_send_light_hsbk(lifx_device_t *device, lifx_hsbk_t color, uint32_t time);
+int lifx_send_light_power(lifx_device_t *device, bool powered, uint32_t time);
+// hands a finished packet to the transport, returns -1 if it would block
+int lifx_transmit(uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port, int interface);
+
+#ifndef LIFX_NO_REQUESTS
+void lifx_reset_requests();
+// hands a reply to the request waiting for it, the header must have already been checked and flipped
+void lifx_complete_request(uint8_t *packet, size_t length);
+void lifx_expire_requests(uint32_t time_now);
+bool lifx_get_request_deadline(uint32_t *deadline);
+#endif
+
+#ifndef LIFX_NO_SEND_QUEUE
+void lifx_reset_queue();
+// transmits the packet, or queues it if the transport is blocked
+void lifx_queue_send(lifx_priority_t priority, uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port, int interface);
+// tries the transport again if it was blocked
+void lifx_retry_queue();
+#endif
+
+#ifndef LIFX_NO_INTERFACES
+void lifx_reset_interfaces();
+// index of the interface whose subnet the address is in, -1 if none match
+int lifx_find_interface(uint32_t ipv4);
+#endif
+
+#ifndef LIFX_NO_QUERY
+void lifx_reset_query();
+// sets or clears LIFX_QUERY_* bits for a device
+void lifx_query_set(lifx_device_t *device, uint8_t property, bool value);
+// moves a device to the group or location it has reported, an all zero ID takes it out of any
+void lifx_query_set_group(lifx_device_t *device, const uint8_t uuid[16]);
+void lifx_query_set_location(lifx_device_t *device, const uint8_t uuid[16]);
+// gets the LIFX_QUERY_* bits a device has
+uint8_t lifx_query_get(lifx_device_t *device);
+// calls visit for every device matching the query (NULL for all), returns the number it returned true for
+typedef bool (*lifx_query_visit_t)(lifx_device_t *device, void *context);
+int lifx_query_each(const lifx_query_t *query, lifx_query_visit_t visit, void *context);
+#endif
+
+#ifndef LIFX_NO_SNAPSHOT
+void lifx_reset_snapshot();
+void lifx_snapshot_changed(lifx_device_t *device);
+// whether a device has changed since a generation, or is part way through a transition
+bool lifx_snapshot_changed_since(lifx_device_t *device, uint32_t since);
+// fills in a record of a device's state, with last_seen_ms relative to time_now
+void lifx_snapshot_record(lifx_device_t *device, lifx_device_record_t *record, uint32_t time_now);
+// marks a device's state as changed, for lifx_snapshot_devices
+#define LIFX_CHANGED(device) lifx_snapshot_changed(device)
+#else
+#define LIFX_CHANGED(device) do { } while (0)
+#endif
+
+#ifndef LIFX_NO_LINK
+// called for every packet from a known device, confirms what was sent with that sequence number if it's the right reply
+void lifx_link_received(lifx_device_t *device, uint8_t sequence, uint16_t type, uint32_t time_now);
+void lifx_link_set_signal(lifx_device_t *device, float signal);
+// remembers a colour that was just sent so it can be resent if the device doesn't confirm it
+void lifx_link_color_sent(lifx_device_t *device, uint8_t sequence, lifx_hsbk_t color, uint32_t duration);
+void lifx_run_links(uint32_t time_now);
+bool lifx_get_link_deadline(uint32_t *deadline);
+#endif
+
+#ifndef LIFX_NO_SCHEDULE
+void lifx_reset_schedule();
+void lifx_run_schedule(uint32_t time_now);
+bool lifx_get_schedule_deadline(uint32_t *deadline);
+// called with the sequence number a scheduled command went out with
+typedef void (*lifx_command_sent_t)(const lifx_command_t *command, uint8_t sequence);
+// as lifx_apply_synchronized, calling sent (if not NULL) as each command goes out
+int lifx_schedule_commands(const lifx_command_t *commands, int count, uint32_t delay_ms, lifx_command_sent_t sent);
+// drops every command still waiting to be sent to device
+void lifx_schedule_cancel(lifx_device_t *device);
+#endif
+
+#ifndef LIFX_NO_SHM
+void lifx_reset_shm();
+// brings the shared memory table up to date if it's due
+void lifx_run_shm(uint32_t time_now);
+bool lifx_get_shm_deadline(uint32_t *deadline);
+#endif
+
+#ifndef LIFX_NO_RECONCILE
+void lifx_reset_reconcile();
+// called once a light's state has been updated from a report, power always and colour if color_reported
+void lifx_reconcile_reported(lifx_device_t *device, bool color_reported);
+void lifx_run_reconcile(uint32_t time_now);
+bool lifx_get_reconcile_deadline(uint32_t *deadline);
+#endif
+
+#ifndef LIFX_NO_SCENES
+void lifx_reset_scenes();
+// called for every packet from a known device, confirms the scene packet sent with that sequence number if it's the right reply
+void lifx_scene_received(lifx_device_t *device, uint8_t sequence, uint16_t type);
+void lifx_expire_scenes(uint32_t time_now);
+bool lifx_get_scene_deadline(uint32_t *deadline);
+#endif
+
+#ifdef LIFX_NO_SYSTEM_TIME
+// provided by the caller when the system clock isn't available
+uint64_t lifx_platform_time_ms(void);
+#endif
+
+#ifndef LIFX_NO_STDIO
+// packet capture, the check is kept inline so it costs a single load when capture is off
+extern atomic_bool lifx_capture_active;
+void lifx_capture_packet(const uint8_t *packet, size_t length, bool outgoing, uint32_t ipv4, uint16_t port);
+#define LIFX_CAPTURE(packet, length, outgoing, ipv4, port) \
+    do { \
+        if (atomic_load_explicit(&lifx_capture_active, memory_order_relaxed)) \
+            lifx_capture_packet(packet, length, outgoing, ipv4, port); \
+    } while (0)
+#else
+#define LIFX_CAPTURE(packet, length, outgoing, ipv4, port) do { } while (0)
+#endif
 
 #endif // LIFX_INTERNAL_H_
@@ -0,0 +1,242 @@
+/*
+    liblifx - lifx_link.c
+    Wi-Fi link monitoring, and the per-device send budgets worked out from it.
+*/
+
+#include <string.h>
+#include <lifx_config.h>
+#ifndef LIFX_NO_LINK
+
+#include "lifx_internal.h"
+#include "lifx_protocol.h"
+#include <lifx.h>
+
+typedef struct _lifx_link_budget_t
+{
+    uint16_t frame_interval; // minimum milliseconds between streamed frames
+    uint8_t retries; // resends of a colour that isn't confirmed
+} lifx_link_budget_t;
+
+// weak links get fewer frames, and each one is given more chances to arrive
+static const lifx_link_budget_t link_budgets[] = {
+    [LIFX_LINK_GOOD] = { 20, 0 },
+    [LIFX_LINK_FAIR] = { 50, 1 },
+    [LIFX_LINK_POOR] = { 100, 2 },
+    [LIFX_LINK_BAD] = { 250, 3 },
+};
+
+#define LIFX_LINK_MIN_TIMEOUT_MS 100 // shortest wait for a reply before it's counted as lost
+#define LIFX_LINK_DEFAULT_TIMEOUT_MS 250 // wait for a reply before there's a round trip to go on
+
+static lifx_link_quality_t lifx_link_quality(const lifx_link_t *link)
+{
+    lifx_link_quality_t quality = LIFX_LINK_GOOD;
+    // the signal is reported in mW, compare against -60, -70 and -80dBm rather than taking a log
+    if (link->signal > 0) {
+        if (link->signal < 1e-8f)
+            quality = LIFX_LINK_BAD;
+        else if (link->signal < 1e-7f)
+            quality = LIFX_LINK_POOR;
+        else if (link->signal < 1e-6f)
+            quality = LIFX_LINK_FAIR;
+    }
+    // a good signal doesn't help if packets still go missing, e.g. on a busy channel
+    if (link->loss >= 77 && quality < LIFX_LINK_BAD) // 30%
+        quality = LIFX_LINK_BAD;
+    else if (link->loss >= 38 && quality < LIFX_LINK_POOR) // 15%
+        quality = LIFX_LINK_POOR;
+    else if (link->loss >= 13 && quality < LIFX_LINK_FAIR) // 5%
+        quality = LIFX_LINK_FAIR;
+    if (link->rtt >= 500 && quality < LIFX_LINK_BAD)
+        quality = LIFX_LINK_BAD;
+    else if (link->rtt >= 250 && quality < LIFX_LINK_POOR)
+        quality = LIFX_LINK_POOR;
+    else if (link->rtt >= 100 && quality < LIFX_LINK_FAIR)
+        quality = LIFX_LINK_FAIR;
+    return quality;
+}
+
+static uint32_t lifx_link_timeout(lifx_device_t *device, const lifx_link_t *link)
+{
+    uint32_t timeout;
+    if (link->rtt != 0)
+        timeout = link->rtt * 2;
+    else if (device->latency > 0)
+        timeout = device->latency * 2;
+    else
+        timeout = LIFX_LINK_DEFAULT_TIMEOUT_MS;
+    return timeout < LIFX_LINK_MIN_TIMEOUT_MS ? LIFX_LINK_MIN_TIMEOUT_MS : timeout;
+}
+
+// both are smoothed over roughly the last eight samples
+static void lifx_link_sample(lifx_link_t *link, bool lost, uint32_t rtt)
+{
+    link->loss = (link->loss * 7 + (lost ? 255 : 0)) / 8;
+    if (lost)
+        return;
+    // 0 means not measured yet, replies on the same host can come back within the millisecond
+    if (rtt == 0)
+        rtt = 1;
+    if (rtt > 0xFFFF)
+        rtt = 0xFFFF;
+    link->rtt = link->rtt == 0 ? rtt : (link->rtt * 7 + rtt) / 8;
+}
+
+static void lifx_link_send_color(lifx_device_t *device, lifx_link_t *link, uint32_t time_now)
+{
+    lifx_set_color_t set_color;
+    uint8_t payload[LIFX_SET_COLOR_SIZE];
+    uint32_t elapsed = time_now - link->color_start;
+    set_color.color = link->color_value;
+    set_color.duration = elapsed < link->color_duration ? link->color_duration - elapsed : 0;
+    lifx_encode_set_color(payload, &set_color);
+    link->color.sequence = lifx_send_packet_priority(device, LIFX_PT_SETCOLOR, payload, sizeof(payload), LIFX_PRIORITY_RETRY);
+    lifx_set_color_sent(device, link->color.sequence);
+    link->color.sent = time_now;
+    link->color.waiting = true;
+}
+
+void lifx_link_received(lifx_device_t *device, uint8_t sequence, uint16_t type, uint32_t time_now)
+{
+    lifx_link_t *link = &lifx_get_device_info(device)->link;
+    if (link->poll.waiting && link->poll.sequence == sequence && type == LIFX_PT_STATEWIFIINFO) {
+        link->poll.waiting = false;
+        lifx_link_sample(link, false, time_now - link->poll.sent);
+    }
+    // SetColor is answered with the light's state
+    if (link->color.waiting && link->color.sequence == sequence && type == LIFX_PT_LIGHTSTATE) {
+        link->color.waiting = false;
+        lifx_link_sample(link, false, time_now - link->color.sent);
+    }
+}
+
+void lifx_link_set_signal(lifx_device_t *device, float signal)
+{
+    lifx_get_device_info(device)->link.signal = signal;
+}
+
+void lifx_link_color_sent(lifx_device_t *device, uint8_t sequence, lifx_hsbk_t color, uint32_t duration)
+{
+    lifx_link_t *link = &lifx_get_device_info(device)->link;
+    // a colour that's been replaced doesn't need confirming any more, and isn't counted as lost
+    link->color.sequence = sequence;
+    link->color.sent = device->last_send;
+    link->color.waiting = true;
+    link->color_start = device->last_send;
+    link->color_duration = duration;
+    link->color_value = color;
+    link->retries_left = link_budgets[lifx_link_quality(link)].retries;
+    // any frame still waiting is older than this colour
+    link->frame_pending = false;
+    link->next_frame = device->last_send + link_budgets[lifx_link_quality(link)].frame_interval;
+}
+
+void lifx_stream_light_hsbk(lifx_device_t *device, uint16_t hue, uint16_t saturation, uint16_t brightness, uint16_t kelvin, uint32_t time)
+{
+    uint32_t time_now = lifx_get_time_relative();
+    lifx_link_t *link;
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE) || !(device->flags & LIFX_DEVICE_IS_LIGHT))
+        return;
+    link = &lifx_get_device_info(device)->link;
+    if (LIFX_BEFORE(time_now, link->next_frame)) {
+        // too soon, only the newest frame is worth sending
+        link->frame.hue = hue;
+        link->frame.saturation = saturation;
+        link->frame.brightness = brightness;
+        link->frame.kelvin = kelvin;
+        link->frame_duration = time;
+        link->frame_pending = true;
+        return;
+    }
+    lifx_set_light_hsbk(device, hue, saturation, brightness, kelvin, time);
+}
+
+int lifx_get_device_link(lifx_device_t *device, lifx_link_info_t *info)
+{
+    lifx_link_t *link;
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE))
+        return -1;
+    if (info != NULL) {
+        link = &lifx_get_device_info(device)->link;
+        info->quality = lifx_link_quality(link);
+        info->signal = link->signal;
+        info->loss_percent = (link->loss * 100 + 127) / 255;
+        info->rtt_ms = link->rtt;
+        info->frame_interval_ms = link_budgets[info->quality].frame_interval;
+        info->retries = link_budgets[info->quality].retries;
+    }
+    return 0;
+}
+
+static void lifx_run_link(lifx_device_t *device, lifx_link_t *link, uint32_t time_now)
+{
+    uint32_t timeout = lifx_link_timeout(device, link);
+    if (link->poll.waiting && time_now - link->poll.sent >= timeout) {
+        link->poll.waiting = false;
+        lifx_link_sample(link, true, 0);
+    }
+    if (link->color.waiting && time_now - link->color.sent >= timeout) {
+        lifx_link_sample(link, true, 0);
+        link->color.waiting = false;
+        // only resend if nothing newer is about to replace it
+        if (link->retries_left > 0 && !link->frame_pending) {
+            link->retries_left--;
+            lifx_link_send_color(device, link, time_now);
+        }
+    }
+    if (link->frame_pending && !LIFX_BEFORE(time_now, link->next_frame)) {
+        link->frame_pending = false;
+        lifx_set_light_hsbk(device, link->frame.hue, link->frame.saturation, link->frame.brightness, link->frame.kelvin,
+            link->frame_duration);
+    }
+    if (!LIFX_BEFORE(time_now, link->next_poll)) {
+        link->poll.sequence = lifx_send_packet_priority(device, LIFX_PT_GETWIFIINFO, NULL, 0, LIFX_PRIORITY_BACKGROUND);
+        link->poll.sent = time_now;
+        link->poll.waiting = true;
+        link->next_poll = time_now + LIFX_LINK_POLL_MS;
+    }
+}
+
+void lifx_run_links(uint32_t time_now)
+{
+    lifx_device_t *devices = lifx_get_devices();
+    int count = lifx_get_device_count();
+    for (int i = 0; i < count; i++) {
+        // devices loaded from the cache are left alone until they've answered discovery
+        if ((devices[i].flags & (LIFX_DEVICE_IN_USE | LIFX_DEVICE_SEEN)) != (LIFX_DEVICE_IN_USE | LIFX_DEVICE_SEEN))
+            continue;
+        lifx_run_link(&devices[i], &lifx_get_device_info(&devices[i])->link, time_now);
+    }
+}
+
+bool lifx_get_link_deadline(uint32_t *deadline)
+{
+    lifx_device_t *devices = lifx_get_devices();
+    int count = lifx_get_device_count();
+    bool found = false;
+    for (int i = 0; i < count; i++) {
+        lifx_device_t *device = &devices[i];
+        if ((device->flags & (LIFX_DEVICE_IN_USE | LIFX_DEVICE_SEEN)) != (LIFX_DEVICE_IN_USE | LIFX_DEVICE_SEEN))
+            continue;
+        lifx_link_t *link = &lifx_get_device_info(device)->link;
+        uint32_t timeout = lifx_link_timeout(device, link);
+        uint32_t candidates[4];
+        int candidate_count = 0;
+        candidates[candidate_count++] = link->next_poll;
+        if (link->poll.waiting)
+            candidates[candidate_count++] = link->poll.sent + timeout;
+        if (link->color.waiting)
+            candidates[candidate_count++] = link->color.sent + timeout;
+        if (link->frame_pending)
+            candidates[candidate_count++] = link->next_frame;
+        for (int j = 0; j < candidate_count; j++) {
+            if (!found || LIFX_BEFORE(candidates[j], *deadline)) {
+                *deadline = candidates[j];
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+#endif // LIFX_NO_LINK
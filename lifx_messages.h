@@ -0,0 +1,1717 @@
+/*
+    liblifx - lifx_messages.h
+    Generated by scripts/protocol_codec.js from scripts/protocol.json, don't edit by hand.
+*/
+
+#ifndef LIFX_MESSAGES_H_
+#define LIFX_MESSAGES_H_
+
+// included from lifx_protocol.h, which provides the lifx_read_* and lifx_write_* functions
+
+typedef enum _lifx_packet_type_t
+{
+    // System packet types
+    LIFX_PT_GETSERVICE = 2,
+    LIFX_PT_STATESERVICE = 3,
+    LIFX_PT_GETHOSTFIRMWARE = 14,
+    LIFX_PT_STATEHOSTFIRMWARE = 15,
+    LIFX_PT_GETWIFIINFO = 16,
+    LIFX_PT_STATEWIFIINFO = 17,
+    LIFX_PT_GETWIFIFIRMWARE = 18,
+    LIFX_PT_STATEWIFIFIRMWARE = 19,
+    LIFX_PT_GETPOWER = 20,
+    LIFX_PT_SETPOWER = 21,
+    LIFX_PT_STATEPOWER = 22,
+    LIFX_PT_GETLABEL = 23,
+    LIFX_PT_SETLABEL = 24,
+    LIFX_PT_STATELABEL = 25,
+    LIFX_PT_GETVERSION = 32,
+    LIFX_PT_STATEVERSION = 33,
+    LIFX_PT_GETINFO = 34,
+    LIFX_PT_STATEINFO = 35,
+    LIFX_PT_SETREBOOT = 38,
+    LIFX_PT_ACKNOWLEDGEMENT = 45,
+    LIFX_PT_GETLOCATION = 48,
+    LIFX_PT_SETLOCATION = 49,
+    LIFX_PT_STATELOCATION = 50,
+    LIFX_PT_GETGROUP = 51,
+    LIFX_PT_SETGROUP = 52,
+    LIFX_PT_STATEGROUP = 53,
+    LIFX_PT_ECHOREQUEST = 58,
+    LIFX_PT_ECHORESPONSE = 59,
+    LIFX_PT_STATEUNHANDLED = 223,
+    // Light packet types
+    LIFX_PT_GETCOLOR = 101,
+    LIFX_PT_SETCOLOR = 102,
+    LIFX_PT_SETWAVEFORM = 103,
+    LIFX_PT_LIGHTSTATE = 107,
+    LIFX_PT_GETLIGHTPOWER = 116,
+    LIFX_PT_SETLIGHTPOWER = 117,
+    LIFX_PT_STATELIGHTPOWER = 118,
+    LIFX_PT_SETWAVEFORMOPTIONAL = 119,
+    LIFX_PT_GETINFRARED = 120,
+    LIFX_PT_STATEINFRARED = 121,
+    LIFX_PT_SETINFRARED = 122,
+    LIFX_PT_GETHEVCYCLE = 142,
+    LIFX_PT_SETHEVCYCLE = 143,
+    LIFX_PT_STATEHEVCYCLE = 144,
+    LIFX_PT_GETHEVCYCLECONFIGURATION = 145,
+    LIFX_PT_SETHEVCYCLECONFIGURATION = 146,
+    LIFX_PT_STATEHEVCYCLECONFIGURATION = 147,
+    LIFX_PT_GETLASTHEVCYCLERESULT = 148,
+    LIFX_PT_STATELASTHEVCYCLERESULT = 149,
+    // Sensor packet types
+    LIFX_PT_SENSORGETAMBIENTLIGHT = 401,
+    LIFX_PT_SENSORSTATEAMBIENTLIGHT = 402,
+    // Multizone packet types
+    LIFX_PT_SETCOLORZONES = 501,
+    LIFX_PT_GETCOLORZONES = 502,
+    LIFX_PT_STATEZONE = 503,
+    LIFX_PT_STATEMULTIZONE = 506,
+    LIFX_PT_GETMULTIZONEEFFECT = 507,
+    LIFX_PT_SETMULTIZONEEFFECT = 508,
+    LIFX_PT_STATEMULTIZONEEFFECT = 509,
+    LIFX_PT_SETEXTENDEDCOLORZONES = 510,
+    LIFX_PT_GETEXTENDEDCOLORZONES = 511,
+    LIFX_PT_STATEEXTENDEDCOLORZONES = 512,
+    // Tile packet types
+    LIFX_PT_GETDEVICECHAIN = 701,
+    LIFX_PT_STATEDEVICECHAIN = 702,
+    LIFX_PT_SETUSERPOSITION = 703,
+    LIFX_PT_GET64 = 707,
+    LIFX_PT_STATE64 = 711,
+    LIFX_PT_SET64 = 715,
+    LIFX_PT_GETTILEEFFECT = 718,
+    LIFX_PT_SETTILEEFFECT = 719,
+    LIFX_PT_STATETILEEFFECT = 720,
+    // Relay packet types
+    LIFX_PT_GETRPOWER = 816,
+    LIFX_PT_SETRPOWER = 817,
+    LIFX_PT_STATERPOWER = 818,
+} lifx_packet_type_t;
+
+typedef enum _lifx_message_t
+{
+    LIFX_MSG_GET_SERVICE,
+    LIFX_MSG_STATE_SERVICE,
+    LIFX_MSG_GET_HOST_FIRMWARE,
+    LIFX_MSG_STATE_HOST_FIRMWARE,
+    LIFX_MSG_GET_WIFI_INFO,
+    LIFX_MSG_STATE_WIFI_INFO,
+    LIFX_MSG_GET_WIFI_FIRMWARE,
+    LIFX_MSG_STATE_WIFI_FIRMWARE,
+    LIFX_MSG_GET_POWER,
+    LIFX_MSG_SET_POWER,
+    LIFX_MSG_STATE_POWER,
+    LIFX_MSG_GET_LABEL,
+    LIFX_MSG_SET_LABEL,
+    LIFX_MSG_STATE_LABEL,
+    LIFX_MSG_GET_VERSION,
+    LIFX_MSG_STATE_VERSION,
+    LIFX_MSG_GET_INFO,
+    LIFX_MSG_STATE_INFO,
+    LIFX_MSG_SET_REBOOT,
+    LIFX_MSG_ACKNOWLEDGEMENT,
+    LIFX_MSG_GET_LOCATION,
+    LIFX_MSG_SET_LOCATION,
+    LIFX_MSG_STATE_LOCATION,
+    LIFX_MSG_GET_GROUP,
+    LIFX_MSG_SET_GROUP,
+    LIFX_MSG_STATE_GROUP,
+    LIFX_MSG_ECHO_REQUEST,
+    LIFX_MSG_ECHO_RESPONSE,
+    LIFX_MSG_STATE_UNHANDLED,
+    LIFX_MSG_GET_COLOR,
+    LIFX_MSG_SET_COLOR,
+    LIFX_MSG_SET_WAVEFORM,
+    LIFX_MSG_LIGHT_STATE,
+    LIFX_MSG_GET_LIGHT_POWER,
+    LIFX_MSG_SET_LIGHT_POWER,
+    LIFX_MSG_STATE_LIGHT_POWER,
+    LIFX_MSG_SET_WAVEFORM_OPTIONAL,
+    LIFX_MSG_GET_INFRARED,
+    LIFX_MSG_STATE_INFRARED,
+    LIFX_MSG_SET_INFRARED,
+    LIFX_MSG_GET_HEV_CYCLE,
+    LIFX_MSG_SET_HEV_CYCLE,
+    LIFX_MSG_STATE_HEV_CYCLE,
+    LIFX_MSG_GET_HEV_CYCLE_CONFIGURATION,
+    LIFX_MSG_SET_HEV_CYCLE_CONFIGURATION,
+    LIFX_MSG_STATE_HEV_CYCLE_CONFIGURATION,
+    LIFX_MSG_GET_LAST_HEV_CYCLE_RESULT,
+    LIFX_MSG_STATE_LAST_HEV_CYCLE_RESULT,
+    LIFX_MSG_SENSOR_GET_AMBIENT_LIGHT,
+    LIFX_MSG_SENSOR_STATE_AMBIENT_LIGHT,
+    LIFX_MSG_SET_COLOR_ZONES,
+    LIFX_MSG_GET_COLOR_ZONES,
+    LIFX_MSG_STATE_ZONE,
+    LIFX_MSG_STATE_MULTI_ZONE,
+    LIFX_MSG_GET_MULTI_ZONE_EFFECT,
+    LIFX_MSG_SET_MULTI_ZONE_EFFECT,
+    LIFX_MSG_STATE_MULTI_ZONE_EFFECT,
+    LIFX_MSG_SET_EXTENDED_COLOR_ZONES,
+    LIFX_MSG_GET_EXTENDED_COLOR_ZONES,
+    LIFX_MSG_STATE_EXTENDED_COLOR_ZONES,
+    LIFX_MSG_GET_DEVICE_CHAIN,
+    LIFX_MSG_STATE_DEVICE_CHAIN,
+    LIFX_MSG_SET_USER_POSITION,
+    LIFX_MSG_GET64,
+    LIFX_MSG_STATE64,
+    LIFX_MSG_SET64,
+    LIFX_MSG_GET_TILE_EFFECT,
+    LIFX_MSG_SET_TILE_EFFECT,
+    LIFX_MSG_STATE_TILE_EFFECT,
+    LIFX_MSG_GET_RPOWER,
+    LIFX_MSG_SET_RPOWER,
+    LIFX_MSG_STATE_RPOWER,
+    LIFX_MESSAGE_COUNT
+} lifx_message_t;
+
+// -- START SHARED STRUCTURES --
+
+#define LIFX_HSBK_SIZE 8
+
+static inline void lifx_decode_hsbk(lifx_hsbk_t *out, const uint8_t *in)
+{
+    out->hue = lifx_read_u16(in);
+    out->saturation = lifx_read_u16(in + 2);
+    out->brightness = lifx_read_u16(in + 4);
+    out->kelvin = lifx_read_u16(in + 6);
+}
+
+static inline void lifx_encode_hsbk(uint8_t *out, const lifx_hsbk_t *in)
+{
+    lifx_write_u16(out, in->hue);
+    lifx_write_u16(out + 2, in->saturation);
+    lifx_write_u16(out + 4, in->brightness);
+    lifx_write_u16(out + 6, in->kelvin);
+}
+
+#define LIFX_TILE_SIZE 55
+typedef struct _lifx_tile_t
+{
+    int16_t accel_meas_x;
+    int16_t accel_meas_y;
+    int16_t accel_meas_z;
+    float user_x;
+    float user_y;
+    uint8_t width;
+    uint8_t height;
+    uint32_t vendor;
+    uint32_t product;
+    uint64_t firmware_build;
+    uint16_t firmware_minor;
+    uint16_t firmware_major;
+} lifx_tile_t;
+
+static inline void lifx_decode_tile(lifx_tile_t *out, const uint8_t *in)
+{
+    out->accel_meas_x = lifx_read_i16(in);
+    out->accel_meas_y = lifx_read_i16(in + 2);
+    out->accel_meas_z = lifx_read_i16(in + 4);
+    out->user_x = lifx_read_f32(in + 8);
+    out->user_y = lifx_read_f32(in + 12);
+    out->width = in[16];
+    out->height = in[17];
+    out->vendor = lifx_read_u32(in + 19);
+    out->product = lifx_read_u32(in + 23);
+    out->firmware_build = lifx_read_u64(in + 31);
+    out->firmware_minor = lifx_read_u16(in + 47);
+    out->firmware_major = lifx_read_u16(in + 49);
+}
+
+static inline void lifx_encode_tile(uint8_t *out, const lifx_tile_t *in)
+{
+    lifx_write_i16(out, in->accel_meas_x);
+    lifx_write_i16(out + 2, in->accel_meas_y);
+    lifx_write_i16(out + 4, in->accel_meas_z);
+    memset(out + 6, 0, 2);
+    lifx_write_f32(out + 8, in->user_x);
+    lifx_write_f32(out + 12, in->user_y);
+    out[16] = in->width;
+    out[17] = in->height;
+    memset(out + 18, 0, 1);
+    lifx_write_u32(out + 19, in->vendor);
+    lifx_write_u32(out + 23, in->product);
+    memset(out + 27, 0, 4);
+    lifx_write_u64(out + 31, in->firmware_build);
+    memset(out + 39, 0, 8);
+    lifx_write_u16(out + 47, in->firmware_minor);
+    lifx_write_u16(out + 49, in->firmware_major);
+    memset(out + 51, 0, 4);
+}
+
+#define LIFX_TILE_EFFECT_SETTINGS_SIZE 186
+typedef struct _lifx_tile_effect_settings_t
+{
+    uint32_t instance_id;
+    uint8_t type;
+    uint32_t speed;
+    uint64_t duration;
+    uint32_t parameters[8];
+    uint8_t palette_count;
+    lifx_hsbk_t palette[16];
+} lifx_tile_effect_settings_t;
+
+static inline void lifx_decode_tile_effect_settings(lifx_tile_effect_settings_t *out, const uint8_t *in)
+{
+    out->instance_id = lifx_read_u32(in);
+    out->type = in[4];
+    out->speed = lifx_read_u32(in + 5);
+    out->duration = lifx_read_u64(in + 9);
+    for (int i = 0; i < 8; i++)
+        out->parameters[i] = lifx_read_u32(in + 25 + i * 4);
+    out->palette_count = in[57];
+    for (int i = 0; i < 16; i++)
+        lifx_decode_hsbk(&out->palette[i], in + 58 + i * 8);
+}
+
+static inline void lifx_encode_tile_effect_settings(uint8_t *out, const lifx_tile_effect_settings_t *in)
+{
+    lifx_write_u32(out, in->instance_id);
+    out[4] = in->type;
+    lifx_write_u32(out + 5, in->speed);
+    lifx_write_u64(out + 9, in->duration);
+    memset(out + 17, 0, 8);
+    for (int i = 0; i < 8; i++)
+        lifx_write_u32(out + 25 + i * 4, in->parameters[i]);
+    out[57] = in->palette_count;
+    for (int i = 0; i < 16; i++)
+        lifx_encode_hsbk(out + 58 + i * 8, &in->palette[i]);
+}
+
+// -- END SHARED STRUCTURES --
+
+// -- START SYSTEM MESSAGES --
+
+// GetService (2)
+#define LIFX_GET_SERVICE_SIZE 0
+
+// StateService (3)
+#define LIFX_STATE_SERVICE_SIZE 5
+typedef struct _lifx_state_service_t
+{
+    uint8_t service;
+    uint32_t port;
+} lifx_state_service_t;
+
+static inline void lifx_decode_state_service(lifx_state_service_t *out, const uint8_t *in)
+{
+    out->service = in[0];
+    out->port = lifx_read_u32(in + 1);
+}
+
+static inline void lifx_encode_state_service(uint8_t *out, const lifx_state_service_t *in)
+{
+    out[0] = in->service;
+    lifx_write_u32(out + 1, in->port);
+}
+
+// GetHostFirmware (14)
+#define LIFX_GET_HOST_FIRMWARE_SIZE 0
+
+// StateHostFirmware (15)
+#define LIFX_STATE_HOST_FIRMWARE_SIZE 20
+typedef struct _lifx_state_host_firmware_t
+{
+    uint64_t build;
+    uint16_t version_minor;
+    uint16_t version_major;
+} lifx_state_host_firmware_t;
+
+static inline void lifx_decode_state_host_firmware(lifx_state_host_firmware_t *out, const uint8_t *in)
+{
+    out->build = lifx_read_u64(in);
+    out->version_minor = lifx_read_u16(in + 16);
+    out->version_major = lifx_read_u16(in + 18);
+}
+
+static inline void lifx_encode_state_host_firmware(uint8_t *out, const lifx_state_host_firmware_t *in)
+{
+    lifx_write_u64(out, in->build);
+    memset(out + 8, 0, 8);
+    lifx_write_u16(out + 16, in->version_minor);
+    lifx_write_u16(out + 18, in->version_major);
+}
+
+// GetWifiInfo (16)
+#define LIFX_GET_WIFI_INFO_SIZE 0
+
+// StateWifiInfo (17)
+#define LIFX_STATE_WIFI_INFO_SIZE 14
+typedef struct _lifx_state_wifi_info_t
+{
+    float signal;
+} lifx_state_wifi_info_t;
+
+static inline void lifx_decode_state_wifi_info(lifx_state_wifi_info_t *out, const uint8_t *in)
+{
+    out->signal = lifx_read_f32(in);
+}
+
+static inline void lifx_encode_state_wifi_info(uint8_t *out, const lifx_state_wifi_info_t *in)
+{
+    lifx_write_f32(out, in->signal);
+    memset(out + 4, 0, 10);
+}
+
+// GetWifiFirmware (18)
+#define LIFX_GET_WIFI_FIRMWARE_SIZE 0
+
+// StateWifiFirmware (19)
+#define LIFX_STATE_WIFI_FIRMWARE_SIZE 20
+typedef struct _lifx_state_wifi_firmware_t
+{
+    uint64_t build;
+    uint16_t version_minor;
+    uint16_t version_major;
+} lifx_state_wifi_firmware_t;
+
+static inline void lifx_decode_state_wifi_firmware(lifx_state_wifi_firmware_t *out, const uint8_t *in)
+{
+    out->build = lifx_read_u64(in);
+    out->version_minor = lifx_read_u16(in + 16);
+    out->version_major = lifx_read_u16(in + 18);
+}
+
+static inline void lifx_encode_state_wifi_firmware(uint8_t *out, const lifx_state_wifi_firmware_t *in)
+{
+    lifx_write_u64(out, in->build);
+    memset(out + 8, 0, 8);
+    lifx_write_u16(out + 16, in->version_minor);
+    lifx_write_u16(out + 18, in->version_major);
+}
+
+// GetPower (20)
+#define LIFX_GET_POWER_SIZE 0
+
+// SetPower (21)
+#define LIFX_SET_POWER_SIZE 2
+typedef struct _lifx_set_power_t
+{
+    uint16_t level;
+} lifx_set_power_t;
+
+static inline void lifx_decode_set_power(lifx_set_power_t *out, const uint8_t *in)
+{
+    out->level = lifx_read_u16(in);
+}
+
+static inline void lifx_encode_set_power(uint8_t *out, const lifx_set_power_t *in)
+{
+    lifx_write_u16(out, in->level);
+}
+
+// StatePower (22)
+#define LIFX_STATE_POWER_SIZE 2
+typedef struct _lifx_state_power_t
+{
+    uint16_t level;
+} lifx_state_power_t;
+
+static inline void lifx_decode_state_power(lifx_state_power_t *out, const uint8_t *in)
+{
+    out->level = lifx_read_u16(in);
+}
+
+static inline void lifx_encode_state_power(uint8_t *out, const lifx_state_power_t *in)
+{
+    lifx_write_u16(out, in->level);
+}
+
+// GetLabel (23)
+#define LIFX_GET_LABEL_SIZE 0
+
+// SetLabel (24)
+#define LIFX_SET_LABEL_SIZE 32
+typedef struct _lifx_set_label_t
+{
+    char label[32];
+} lifx_set_label_t;
+
+static inline void lifx_decode_set_label(lifx_set_label_t *out, const uint8_t *in)
+{
+    memcpy(out->label, in, 32);
+}
+
+static inline void lifx_encode_set_label(uint8_t *out, const lifx_set_label_t *in)
+{
+    memcpy(out, in->label, 32);
+}
+
+// StateLabel (25)
+#define LIFX_STATE_LABEL_SIZE 32
+typedef struct _lifx_state_label_t
+{
+    char label[32];
+} lifx_state_label_t;
+
+static inline void lifx_decode_state_label(lifx_state_label_t *out, const uint8_t *in)
+{
+    memcpy(out->label, in, 32);
+}
+
+static inline void lifx_encode_state_label(uint8_t *out, const lifx_state_label_t *in)
+{
+    memcpy(out, in->label, 32);
+}
+
+// GetVersion (32)
+#define LIFX_GET_VERSION_SIZE 0
+
+// StateVersion (33)
+#define LIFX_STATE_VERSION_SIZE 12
+typedef struct _lifx_state_version_t
+{
+    uint32_t vendor;
+    uint32_t product;
+} lifx_state_version_t;
+
+static inline void lifx_decode_state_version(lifx_state_version_t *out, const uint8_t *in)
+{
+    out->vendor = lifx_read_u32(in);
+    out->product = lifx_read_u32(in + 4);
+}
+
+static inline void lifx_encode_state_version(uint8_t *out, const lifx_state_version_t *in)
+{
+    lifx_write_u32(out, in->vendor);
+    lifx_write_u32(out + 4, in->product);
+    memset(out + 8, 0, 4);
+}
+
+// GetInfo (34)
+#define LIFX_GET_INFO_SIZE 0
+
+// StateInfo (35)
+#define LIFX_STATE_INFO_SIZE 24
+typedef struct _lifx_state_info_t
+{
+    uint64_t time;
+    uint64_t uptime;
+    uint64_t downtime;
+} lifx_state_info_t;
+
+static inline void lifx_decode_state_info(lifx_state_info_t *out, const uint8_t *in)
+{
+    out->time = lifx_read_u64(in);
+    out->uptime = lifx_read_u64(in + 8);
+    out->downtime = lifx_read_u64(in + 16);
+}
+
+static inline void lifx_encode_state_info(uint8_t *out, const lifx_state_info_t *in)
+{
+    lifx_write_u64(out, in->time);
+    lifx_write_u64(out + 8, in->uptime);
+    lifx_write_u64(out + 16, in->downtime);
+}
+
+// SetReboot (38)
+#define LIFX_SET_REBOOT_SIZE 0
+
+// Acknowledgement (45)
+#define LIFX_ACKNOWLEDGEMENT_SIZE 0
+
+// GetLocation (48)
+#define LIFX_GET_LOCATION_SIZE 0
+
+// SetLocation (49)
+#define LIFX_SET_LOCATION_SIZE 56
+typedef struct _lifx_set_location_t
+{
+    uint8_t location[16];
+    char label[32];
+    uint64_t updated_at;
+} lifx_set_location_t;
+
+static inline void lifx_decode_set_location(lifx_set_location_t *out, const uint8_t *in)
+{
+    memcpy(out->location, in, 16);
+    memcpy(out->label, in + 16, 32);
+    out->updated_at = lifx_read_u64(in + 48);
+}
+
+static inline void lifx_encode_set_location(uint8_t *out, const lifx_set_location_t *in)
+{
+    memcpy(out, in->location, 16);
+    memcpy(out + 16, in->label, 32);
+    lifx_write_u64(out + 48, in->updated_at);
+}
+
+// StateLocation (50)
+#define LIFX_STATE_LOCATION_SIZE 56
+typedef struct _lifx_state_location_t
+{
+    uint8_t location[16];
+    char label[32];
+    uint64_t updated_at;
+} lifx_state_location_t;
+
+static inline void lifx_decode_state_location(lifx_state_location_t *out, const uint8_t *in)
+{
+    memcpy(out->location, in, 16);
+    memcpy(out->label, in + 16, 32);
+    out->updated_at = lifx_read_u64(in + 48);
+}
+
+static inline void lifx_encode_state_location(uint8_t *out, const lifx_state_location_t *in)
+{
+    memcpy(out, in->location, 16);
+    memcpy(out + 16, in->label, 32);
+    lifx_write_u64(out + 48, in->updated_at);
+}
+
+// GetGroup (51)
+#define LIFX_GET_GROUP_SIZE 0
+
+// SetGroup (52)
+#define LIFX_SET_GROUP_SIZE 56
+typedef struct _lifx_set_group_t
+{
+    uint8_t group[16];
+    char label[32];
+    uint64_t updated_at;
+} lifx_set_group_t;
+
+static inline void lifx_decode_set_group(lifx_set_group_t *out, const uint8_t *in)
+{
+    memcpy(out->group, in, 16);
+    memcpy(out->label, in + 16, 32);
+    out->updated_at = lifx_read_u64(in + 48);
+}
+
+static inline void lifx_encode_set_group(uint8_t *out, const lifx_set_group_t *in)
+{
+    memcpy(out, in->group, 16);
+    memcpy(out + 16, in->label, 32);
+    lifx_write_u64(out + 48, in->updated_at);
+}
+
+// StateGroup (53)
+#define LIFX_STATE_GROUP_SIZE 56
+typedef struct _lifx_state_group_t
+{
+    uint8_t group[16];
+    char label[32];
+    uint64_t updated_at;
+} lifx_state_group_t;
+
+static inline void lifx_decode_state_group(lifx_state_group_t *out, const uint8_t *in)
+{
+    memcpy(out->group, in, 16);
+    memcpy(out->label, in + 16, 32);
+    out->updated_at = lifx_read_u64(in + 48);
+}
+
+static inline void lifx_encode_state_group(uint8_t *out, const lifx_state_group_t *in)
+{
+    memcpy(out, in->group, 16);
+    memcpy(out + 16, in->label, 32);
+    lifx_write_u64(out + 48, in->updated_at);
+}
+
+// EchoRequest (58)
+#define LIFX_ECHO_REQUEST_SIZE 64
+typedef struct _lifx_echo_request_t
+{
+    uint8_t echoing[64];
+} lifx_echo_request_t;
+
+static inline void lifx_decode_echo_request(lifx_echo_request_t *out, const uint8_t *in)
+{
+    memcpy(out->echoing, in, 64);
+}
+
+static inline void lifx_encode_echo_request(uint8_t *out, const lifx_echo_request_t *in)
+{
+    memcpy(out, in->echoing, 64);
+}
+
+// EchoResponse (59)
+#define LIFX_ECHO_RESPONSE_SIZE 64
+typedef struct _lifx_echo_response_t
+{
+    uint8_t echoing[64];
+} lifx_echo_response_t;
+
+static inline void lifx_decode_echo_response(lifx_echo_response_t *out, const uint8_t *in)
+{
+    memcpy(out->echoing, in, 64);
+}
+
+static inline void lifx_encode_echo_response(uint8_t *out, const lifx_echo_response_t *in)
+{
+    memcpy(out, in->echoing, 64);
+}
+
+// StateUnhandled (223)
+#define LIFX_STATE_UNHANDLED_SIZE 2
+typedef struct _lifx_state_unhandled_t
+{
+    uint16_t unhandled_type;
+} lifx_state_unhandled_t;
+
+static inline void lifx_decode_state_unhandled(lifx_state_unhandled_t *out, const uint8_t *in)
+{
+    out->unhandled_type = lifx_read_u16(in);
+}
+
+static inline void lifx_encode_state_unhandled(uint8_t *out, const lifx_state_unhandled_t *in)
+{
+    lifx_write_u16(out, in->unhandled_type);
+}
+
+// -- END SYSTEM MESSAGES --
+
+// -- START LIGHT MESSAGES --
+
+// GetColor (101)
+#define LIFX_GET_COLOR_SIZE 0
+
+// SetColor (102)
+#define LIFX_SET_COLOR_SIZE 13
+typedef struct _lifx_set_color_t
+{
+    lifx_hsbk_t color;
+    uint32_t duration;
+} lifx_set_color_t;
+
+static inline void lifx_decode_set_color(lifx_set_color_t *out, const uint8_t *in)
+{
+    lifx_decode_hsbk(&out->color, in + 1);
+    out->duration = lifx_read_u32(in + 9);
+}
+
+static inline void lifx_encode_set_color(uint8_t *out, const lifx_set_color_t *in)
+{
+    memset(out, 0, 1);
+    lifx_encode_hsbk(out + 1, &in->color);
+    lifx_write_u32(out + 9, in->duration);
+}
+
+// SetWaveform (103)
+#define LIFX_SET_WAVEFORM_SIZE 21
+typedef struct _lifx_set_waveform_t
+{
+    bool transient;
+    lifx_hsbk_t color;
+    uint32_t period;
+    float cycles;
+    int16_t skew_ratio;
+    uint8_t waveform;
+} lifx_set_waveform_t;
+
+static inline void lifx_decode_set_waveform(lifx_set_waveform_t *out, const uint8_t *in)
+{
+    out->transient = in[1] != 0;
+    lifx_decode_hsbk(&out->color, in + 2);
+    out->period = lifx_read_u32(in + 10);
+    out->cycles = lifx_read_f32(in + 14);
+    out->skew_ratio = lifx_read_i16(in + 18);
+    out->waveform = in[20];
+}
+
+static inline void lifx_encode_set_waveform(uint8_t *out, const lifx_set_waveform_t *in)
+{
+    memset(out, 0, 1);
+    out[1] = in->transient;
+    lifx_encode_hsbk(out + 2, &in->color);
+    lifx_write_u32(out + 10, in->period);
+    lifx_write_f32(out + 14, in->cycles);
+    lifx_write_i16(out + 18, in->skew_ratio);
+    out[20] = in->waveform;
+}
+
+// LightState (107)
+#define LIFX_LIGHT_STATE_SIZE 52
+typedef struct _lifx_light_state_t
+{
+    lifx_hsbk_t color;
+    uint16_t power;
+    char label[32];
+} lifx_light_state_t;
+
+static inline void lifx_decode_light_state(lifx_light_state_t *out, const uint8_t *in)
+{
+    lifx_decode_hsbk(&out->color, in);
+    out->power = lifx_read_u16(in + 10);
+    memcpy(out->label, in + 12, 32);
+}
+
+static inline void lifx_encode_light_state(uint8_t *out, const lifx_light_state_t *in)
+{
+    lifx_encode_hsbk(out, &in->color);
+    memset(out + 8, 0, 2);
+    lifx_write_u16(out + 10, in->power);
+    memcpy(out + 12, in->label, 32);
+    memset(out + 44, 0, 8);
+}
+
+// GetLightPower (116)
+#define LIFX_GET_LIGHT_POWER_SIZE 0
+
+// SetLightPower (117)
+#define LIFX_SET_LIGHT_POWER_SIZE 6
+typedef struct _lifx_set_light_power_t
+{
+    uint16_t level;
+    uint32_t duration;
+} lifx_set_light_power_t;
+
+static inline void lifx_decode_set_light_power(lifx_set_light_power_t *out, const uint8_t *in)
+{
+    out->level = lifx_read_u16(in);
+    out->duration = lifx_read_u32(in + 2);
+}
+
+static inline void lifx_encode_set_light_power(uint8_t *out, const lifx_set_light_power_t *in)
+{
+    lifx_write_u16(out, in->level);
+    lifx_write_u32(out + 2, in->duration);
+}
+
+// StateLightPower (118)
+#define LIFX_STATE_LIGHT_POWER_SIZE 2
+typedef struct _lifx_state_light_power_t
+{
+    uint16_t level;
+} lifx_state_light_power_t;
+
+static inline void lifx_decode_state_light_power(lifx_state_light_power_t *out, const uint8_t *in)
+{
+    out->level = lifx_read_u16(in);
+}
+
+static inline void lifx_encode_state_light_power(uint8_t *out, const lifx_state_light_power_t *in)
+{
+    lifx_write_u16(out, in->level);
+}
+
+// SetWaveformOptional (119)
+#define LIFX_SET_WAVEFORM_OPTIONAL_SIZE 25
+typedef struct _lifx_set_waveform_optional_t
+{
+    bool transient;
+    lifx_hsbk_t color;
+    uint32_t period;
+    float cycles;
+    int16_t skew_ratio;
+    uint8_t waveform;
+    bool set_hue;
+    bool set_saturation;
+    bool set_brightness;
+    bool set_kelvin;
+} lifx_set_waveform_optional_t;
+
+static inline void lifx_decode_set_waveform_optional(lifx_set_waveform_optional_t *out, const uint8_t *in)
+{
+    out->transient = in[1] != 0;
+    lifx_decode_hsbk(&out->color, in + 2);
+    out->period = lifx_read_u32(in + 10);
+    out->cycles = lifx_read_f32(in + 14);
+    out->skew_ratio = lifx_read_i16(in + 18);
+    out->waveform = in[20];
+    out->set_hue = in[21] != 0;
+    out->set_saturation = in[22] != 0;
+    out->set_brightness = in[23] != 0;
+    out->set_kelvin = in[24] != 0;
+}
+
+static inline void lifx_encode_set_waveform_optional(uint8_t *out, const lifx_set_waveform_optional_t *in)
+{
+    memset(out, 0, 1);
+    out[1] = in->transient;
+    lifx_encode_hsbk(out + 2, &in->color);
+    lifx_write_u32(out + 10, in->period);
+    lifx_write_f32(out + 14, in->cycles);
+    lifx_write_i16(out + 18, in->skew_ratio);
+    out[20] = in->waveform;
+    out[21] = in->set_hue;
+    out[22] = in->set_saturation;
+    out[23] = in->set_brightness;
+    out[24] = in->set_kelvin;
+}
+
+// GetInfrared (120)
+#define LIFX_GET_INFRARED_SIZE 0
+
+// StateInfrared (121)
+#define LIFX_STATE_INFRARED_SIZE 2
+typedef struct _lifx_state_infrared_t
+{
+    uint16_t brightness;
+} lifx_state_infrared_t;
+
+static inline void lifx_decode_state_infrared(lifx_state_infrared_t *out, const uint8_t *in)
+{
+    out->brightness = lifx_read_u16(in);
+}
+
+static inline void lifx_encode_state_infrared(uint8_t *out, const lifx_state_infrared_t *in)
+{
+    lifx_write_u16(out, in->brightness);
+}
+
+// SetInfrared (122)
+#define LIFX_SET_INFRARED_SIZE 2
+typedef struct _lifx_set_infrared_t
+{
+    uint16_t brightness;
+} lifx_set_infrared_t;
+
+static inline void lifx_decode_set_infrared(lifx_set_infrared_t *out, const uint8_t *in)
+{
+    out->brightness = lifx_read_u16(in);
+}
+
+static inline void lifx_encode_set_infrared(uint8_t *out, const lifx_set_infrared_t *in)
+{
+    lifx_write_u16(out, in->brightness);
+}
+
+// GetHevCycle (142)
+#define LIFX_GET_HEV_CYCLE_SIZE 0
+
+// SetHevCycle (143)
+#define LIFX_SET_HEV_CYCLE_SIZE 5
+typedef struct _lifx_set_hev_cycle_t
+{
+    bool enable;
+    uint32_t duration_s;
+} lifx_set_hev_cycle_t;
+
+static inline void lifx_decode_set_hev_cycle(lifx_set_hev_cycle_t *out, const uint8_t *in)
+{
+    out->enable = in[0] != 0;
+    out->duration_s = lifx_read_u32(in + 1);
+}
+
+static inline void lifx_encode_set_hev_cycle(uint8_t *out, const lifx_set_hev_cycle_t *in)
+{
+    out[0] = in->enable;
+    lifx_write_u32(out + 1, in->duration_s);
+}
+
+// StateHevCycle (144)
+#define LIFX_STATE_HEV_CYCLE_SIZE 9
+typedef struct _lifx_state_hev_cycle_t
+{
+    uint32_t duration_s;
+    uint32_t remaining_s;
+    bool last_power;
+} lifx_state_hev_cycle_t;
+
+static inline void lifx_decode_state_hev_cycle(lifx_state_hev_cycle_t *out, const uint8_t *in)
+{
+    out->duration_s = lifx_read_u32(in);
+    out->remaining_s = lifx_read_u32(in + 4);
+    out->last_power = in[8] != 0;
+}
+
+static inline void lifx_encode_state_hev_cycle(uint8_t *out, const lifx_state_hev_cycle_t *in)
+{
+    lifx_write_u32(out, in->duration_s);
+    lifx_write_u32(out + 4, in->remaining_s);
+    out[8] = in->last_power;
+}
+
+// GetHevCycleConfiguration (145)
+#define LIFX_GET_HEV_CYCLE_CONFIGURATION_SIZE 0
+
+// SetHevCycleConfiguration (146)
+#define LIFX_SET_HEV_CYCLE_CONFIGURATION_SIZE 5
+typedef struct _lifx_set_hev_cycle_configuration_t
+{
+    bool indication;
+    uint32_t duration_s;
+} lifx_set_hev_cycle_configuration_t;
+
+static inline void lifx_decode_set_hev_cycle_configuration(lifx_set_hev_cycle_configuration_t *out, const uint8_t *in)
+{
+    out->indication = in[0] != 0;
+    out->duration_s = lifx_read_u32(in + 1);
+}
+
+static inline void lifx_encode_set_hev_cycle_configuration(uint8_t *out, const lifx_set_hev_cycle_configuration_t *in)
+{
+    out[0] = in->indication;
+    lifx_write_u32(out + 1, in->duration_s);
+}
+
+// StateHevCycleConfiguration (147)
+#define LIFX_STATE_HEV_CYCLE_CONFIGURATION_SIZE 5
+typedef struct _lifx_state_hev_cycle_configuration_t
+{
+    bool indication;
+    uint32_t duration_s;
+} lifx_state_hev_cycle_configuration_t;
+
+static inline void lifx_decode_state_hev_cycle_configuration(lifx_state_hev_cycle_configuration_t *out, const uint8_t *in)
+{
+    out->indication = in[0] != 0;
+    out->duration_s = lifx_read_u32(in + 1);
+}
+
+static inline void lifx_encode_state_hev_cycle_configuration(uint8_t *out, const lifx_state_hev_cycle_configuration_t *in)
+{
+    out[0] = in->indication;
+    lifx_write_u32(out + 1, in->duration_s);
+}
+
+// GetLastHevCycleResult (148)
+#define LIFX_GET_LAST_HEV_CYCLE_RESULT_SIZE 0
+
+// StateLastHevCycleResult (149)
+#define LIFX_STATE_LAST_HEV_CYCLE_RESULT_SIZE 1
+typedef struct _lifx_state_last_hev_cycle_result_t
+{
+    uint8_t result;
+} lifx_state_last_hev_cycle_result_t;
+
+static inline void lifx_decode_state_last_hev_cycle_result(lifx_state_last_hev_cycle_result_t *out, const uint8_t *in)
+{
+    out->result = in[0];
+}
+
+static inline void lifx_encode_state_last_hev_cycle_result(uint8_t *out, const lifx_state_last_hev_cycle_result_t *in)
+{
+    out[0] = in->result;
+}
+
+// -- END LIGHT MESSAGES --
+
+// -- START SENSOR MESSAGES --
+
+// SensorGetAmbientLight (401)
+#define LIFX_SENSOR_GET_AMBIENT_LIGHT_SIZE 0
+
+// SensorStateAmbientLight (402)
+#define LIFX_SENSOR_STATE_AMBIENT_LIGHT_SIZE 4
+typedef struct _lifx_sensor_state_ambient_light_t
+{
+    float lux;
+} lifx_sensor_state_ambient_light_t;
+
+static inline void lifx_decode_sensor_state_ambient_light(lifx_sensor_state_ambient_light_t *out, const uint8_t *in)
+{
+    out->lux = lifx_read_f32(in);
+}
+
+static inline void lifx_encode_sensor_state_ambient_light(uint8_t *out, const lifx_sensor_state_ambient_light_t *in)
+{
+    lifx_write_f32(out, in->lux);
+}
+
+// -- END SENSOR MESSAGES --
+
+// -- START MULTIZONE MESSAGES --
+
+// SetColorZones (501)
+#define LIFX_SET_COLOR_ZONES_SIZE 15
+typedef struct _lifx_set_color_zones_t
+{
+    uint8_t start_index;
+    uint8_t end_index;
+    lifx_hsbk_t color;
+    uint32_t duration;
+    uint8_t apply;
+} lifx_set_color_zones_t;
+
+static inline void lifx_decode_set_color_zones(lifx_set_color_zones_t *out, const uint8_t *in)
+{
+    out->start_index = in[0];
+    out->end_index = in[1];
+    lifx_decode_hsbk(&out->color, in + 2);
+    out->duration = lifx_read_u32(in + 10);
+    out->apply = in[14];
+}
+
+static inline void lifx_encode_set_color_zones(uint8_t *out, const lifx_set_color_zones_t *in)
+{
+    out[0] = in->start_index;
+    out[1] = in->end_index;
+    lifx_encode_hsbk(out + 2, &in->color);
+    lifx_write_u32(out + 10, in->duration);
+    out[14] = in->apply;
+}
+
+// GetColorZones (502)
+#define LIFX_GET_COLOR_ZONES_SIZE 2
+typedef struct _lifx_get_color_zones_t
+{
+    uint8_t start_index;
+    uint8_t end_index;
+} lifx_get_color_zones_t;
+
+static inline void lifx_decode_get_color_zones(lifx_get_color_zones_t *out, const uint8_t *in)
+{
+    out->start_index = in[0];
+    out->end_index = in[1];
+}
+
+static inline void lifx_encode_get_color_zones(uint8_t *out, const lifx_get_color_zones_t *in)
+{
+    out[0] = in->start_index;
+    out[1] = in->end_index;
+}
+
+// StateZone (503)
+#define LIFX_STATE_ZONE_SIZE 10
+typedef struct _lifx_state_zone_t
+{
+    uint8_t zones_count;
+    uint8_t zone_index;
+    lifx_hsbk_t color;
+} lifx_state_zone_t;
+
+static inline void lifx_decode_state_zone(lifx_state_zone_t *out, const uint8_t *in)
+{
+    out->zones_count = in[0];
+    out->zone_index = in[1];
+    lifx_decode_hsbk(&out->color, in + 2);
+}
+
+static inline void lifx_encode_state_zone(uint8_t *out, const lifx_state_zone_t *in)
+{
+    out[0] = in->zones_count;
+    out[1] = in->zone_index;
+    lifx_encode_hsbk(out + 2, &in->color);
+}
+
+// StateMultiZone (506)
+#define LIFX_STATE_MULTI_ZONE_SIZE 66
+typedef struct _lifx_state_multi_zone_t
+{
+    uint8_t zones_count;
+    uint8_t zone_index;
+    lifx_hsbk_t colors[8];
+} lifx_state_multi_zone_t;
+
+static inline void lifx_decode_state_multi_zone(lifx_state_multi_zone_t *out, const uint8_t *in)
+{
+    out->zones_count = in[0];
+    out->zone_index = in[1];
+    for (int i = 0; i < 8; i++)
+        lifx_decode_hsbk(&out->colors[i], in + 2 + i * 8);
+}
+
+static inline void lifx_encode_state_multi_zone(uint8_t *out, const lifx_state_multi_zone_t *in)
+{
+    out[0] = in->zones_count;
+    out[1] = in->zone_index;
+    for (int i = 0; i < 8; i++)
+        lifx_encode_hsbk(out + 2 + i * 8, &in->colors[i]);
+}
+
+// GetMultiZoneEffect (507)
+#define LIFX_GET_MULTI_ZONE_EFFECT_SIZE 0
+
+// SetMultiZoneEffect (508)
+#define LIFX_SET_MULTI_ZONE_EFFECT_SIZE 59
+typedef struct _lifx_set_multi_zone_effect_t
+{
+    uint32_t instance_id;
+    uint8_t type;
+    uint32_t speed;
+    uint64_t duration;
+    uint32_t parameters[8];
+} lifx_set_multi_zone_effect_t;
+
+static inline void lifx_decode_set_multi_zone_effect(lifx_set_multi_zone_effect_t *out, const uint8_t *in)
+{
+    out->instance_id = lifx_read_u32(in);
+    out->type = in[4];
+    out->speed = lifx_read_u32(in + 7);
+    out->duration = lifx_read_u64(in + 11);
+    for (int i = 0; i < 8; i++)
+        out->parameters[i] = lifx_read_u32(in + 27 + i * 4);
+}
+
+static inline void lifx_encode_set_multi_zone_effect(uint8_t *out, const lifx_set_multi_zone_effect_t *in)
+{
+    lifx_write_u32(out, in->instance_id);
+    out[4] = in->type;
+    memset(out + 5, 0, 2);
+    lifx_write_u32(out + 7, in->speed);
+    lifx_write_u64(out + 11, in->duration);
+    memset(out + 19, 0, 8);
+    for (int i = 0; i < 8; i++)
+        lifx_write_u32(out + 27 + i * 4, in->parameters[i]);
+}
+
+// StateMultiZoneEffect (509)
+#define LIFX_STATE_MULTI_ZONE_EFFECT_SIZE 59
+typedef struct _lifx_state_multi_zone_effect_t
+{
+    uint32_t instance_id;
+    uint8_t type;
+    uint32_t speed;
+    uint64_t duration;
+    uint32_t parameters[8];
+} lifx_state_multi_zone_effect_t;
+
+static inline void lifx_decode_state_multi_zone_effect(lifx_state_multi_zone_effect_t *out, const uint8_t *in)
+{
+    out->instance_id = lifx_read_u32(in);
+    out->type = in[4];
+    out->speed = lifx_read_u32(in + 7);
+    out->duration = lifx_read_u64(in + 11);
+    for (int i = 0; i < 8; i++)
+        out->parameters[i] = lifx_read_u32(in + 27 + i * 4);
+}
+
+static inline void lifx_encode_state_multi_zone_effect(uint8_t *out, const lifx_state_multi_zone_effect_t *in)
+{
+    lifx_write_u32(out, in->instance_id);
+    out[4] = in->type;
+    memset(out + 5, 0, 2);
+    lifx_write_u32(out + 7, in->speed);
+    lifx_write_u64(out + 11, in->duration);
+    memset(out + 19, 0, 8);
+    for (int i = 0; i < 8; i++)
+        lifx_write_u32(out + 27 + i * 4, in->parameters[i]);
+}
+
+// SetExtendedColorZones (510)
+#define LIFX_SET_EXTENDED_COLOR_ZONES_SIZE 664
+typedef struct _lifx_set_extended_color_zones_t
+{
+    uint32_t duration;
+    uint8_t apply;
+    uint16_t zone_index;
+    uint8_t colors_count;
+    lifx_hsbk_t colors[82];
+} lifx_set_extended_color_zones_t;
+
+static inline void lifx_decode_set_extended_color_zones(lifx_set_extended_color_zones_t *out, const uint8_t *in)
+{
+    out->duration = lifx_read_u32(in);
+    out->apply = in[4];
+    out->zone_index = lifx_read_u16(in + 5);
+    out->colors_count = in[7];
+    for (int i = 0; i < 82; i++)
+        lifx_decode_hsbk(&out->colors[i], in + 8 + i * 8);
+}
+
+static inline void lifx_encode_set_extended_color_zones(uint8_t *out, const lifx_set_extended_color_zones_t *in)
+{
+    lifx_write_u32(out, in->duration);
+    out[4] = in->apply;
+    lifx_write_u16(out + 5, in->zone_index);
+    out[7] = in->colors_count;
+    for (int i = 0; i < 82; i++)
+        lifx_encode_hsbk(out + 8 + i * 8, &in->colors[i]);
+}
+
+// GetExtendedColorZones (511)
+#define LIFX_GET_EXTENDED_COLOR_ZONES_SIZE 0
+
+// StateExtendedColorZones (512)
+#define LIFX_STATE_EXTENDED_COLOR_ZONES_SIZE 661
+typedef struct _lifx_state_extended_color_zones_t
+{
+    uint16_t zones_count;
+    uint16_t zone_index;
+    uint8_t colors_count;
+    lifx_hsbk_t colors[82];
+} lifx_state_extended_color_zones_t;
+
+static inline void lifx_decode_state_extended_color_zones(lifx_state_extended_color_zones_t *out, const uint8_t *in)
+{
+    out->zones_count = lifx_read_u16(in);
+    out->zone_index = lifx_read_u16(in + 2);
+    out->colors_count = in[4];
+    for (int i = 0; i < 82; i++)
+        lifx_decode_hsbk(&out->colors[i], in + 5 + i * 8);
+}
+
+static inline void lifx_encode_state_extended_color_zones(uint8_t *out, const lifx_state_extended_color_zones_t *in)
+{
+    lifx_write_u16(out, in->zones_count);
+    lifx_write_u16(out + 2, in->zone_index);
+    out[4] = in->colors_count;
+    for (int i = 0; i < 82; i++)
+        lifx_encode_hsbk(out + 5 + i * 8, &in->colors[i]);
+}
+
+// -- END MULTIZONE MESSAGES --
+
+// -- START TILE MESSAGES --
+
+// GetDeviceChain (701)
+#define LIFX_GET_DEVICE_CHAIN_SIZE 0
+
+// StateDeviceChain (702)
+#define LIFX_STATE_DEVICE_CHAIN_SIZE 882
+typedef struct _lifx_state_device_chain_t
+{
+    uint8_t start_index;
+    lifx_tile_t tile_devices[16];
+    uint8_t tile_devices_count;
+} lifx_state_device_chain_t;
+
+static inline void lifx_decode_state_device_chain(lifx_state_device_chain_t *out, const uint8_t *in)
+{
+    out->start_index = in[0];
+    for (int i = 0; i < 16; i++)
+        lifx_decode_tile(&out->tile_devices[i], in + 1 + i * 55);
+    out->tile_devices_count = in[881];
+}
+
+static inline void lifx_encode_state_device_chain(uint8_t *out, const lifx_state_device_chain_t *in)
+{
+    out[0] = in->start_index;
+    for (int i = 0; i < 16; i++)
+        lifx_encode_tile(out + 1 + i * 55, &in->tile_devices[i]);
+    out[881] = in->tile_devices_count;
+}
+
+// SetUserPosition (703)
+#define LIFX_SET_USER_POSITION_SIZE 11
+typedef struct _lifx_set_user_position_t
+{
+    uint8_t tile_index;
+    float user_x;
+    float user_y;
+} lifx_set_user_position_t;
+
+static inline void lifx_decode_set_user_position(lifx_set_user_position_t *out, const uint8_t *in)
+{
+    out->tile_index = in[0];
+    out->user_x = lifx_read_f32(in + 3);
+    out->user_y = lifx_read_f32(in + 7);
+}
+
+static inline void lifx_encode_set_user_position(uint8_t *out, const lifx_set_user_position_t *in)
+{
+    out[0] = in->tile_index;
+    memset(out + 1, 0, 2);
+    lifx_write_f32(out + 3, in->user_x);
+    lifx_write_f32(out + 7, in->user_y);
+}
+
+// Get64 (707)
+#define LIFX_GET64_SIZE 6
+typedef struct _lifx_get64_t
+{
+    uint8_t tile_index;
+    uint8_t length;
+    uint8_t x;
+    uint8_t y;
+    uint8_t width;
+} lifx_get64_t;
+
+static inline void lifx_decode_get64(lifx_get64_t *out, const uint8_t *in)
+{
+    out->tile_index = in[0];
+    out->length = in[1];
+    out->x = in[3];
+    out->y = in[4];
+    out->width = in[5];
+}
+
+static inline void lifx_encode_get64(uint8_t *out, const lifx_get64_t *in)
+{
+    out[0] = in->tile_index;
+    out[1] = in->length;
+    memset(out + 2, 0, 1);
+    out[3] = in->x;
+    out[4] = in->y;
+    out[5] = in->width;
+}
+
+// State64 (711)
+#define LIFX_STATE64_SIZE 517
+typedef struct _lifx_state64_t
+{
+    uint8_t tile_index;
+    uint8_t x;
+    uint8_t y;
+    uint8_t width;
+    lifx_hsbk_t colors[64];
+} lifx_state64_t;
+
+static inline void lifx_decode_state64(lifx_state64_t *out, const uint8_t *in)
+{
+    out->tile_index = in[0];
+    out->x = in[2];
+    out->y = in[3];
+    out->width = in[4];
+    for (int i = 0; i < 64; i++)
+        lifx_decode_hsbk(&out->colors[i], in + 5 + i * 8);
+}
+
+static inline void lifx_encode_state64(uint8_t *out, const lifx_state64_t *in)
+{
+    out[0] = in->tile_index;
+    memset(out + 1, 0, 1);
+    out[2] = in->x;
+    out[3] = in->y;
+    out[4] = in->width;
+    for (int i = 0; i < 64; i++)
+        lifx_encode_hsbk(out + 5 + i * 8, &in->colors[i]);
+}
+
+// Set64 (715)
+#define LIFX_SET64_SIZE 522
+typedef struct _lifx_set64_t
+{
+    uint8_t tile_index;
+    uint8_t length;
+    uint8_t x;
+    uint8_t y;
+    uint8_t width;
+    uint32_t duration;
+    lifx_hsbk_t colors[64];
+} lifx_set64_t;
+
+static inline void lifx_decode_set64(lifx_set64_t *out, const uint8_t *in)
+{
+    out->tile_index = in[0];
+    out->length = in[1];
+    out->x = in[3];
+    out->y = in[4];
+    out->width = in[5];
+    out->duration = lifx_read_u32(in + 6);
+    for (int i = 0; i < 64; i++)
+        lifx_decode_hsbk(&out->colors[i], in + 10 + i * 8);
+}
+
+static inline void lifx_encode_set64(uint8_t *out, const lifx_set64_t *in)
+{
+    out[0] = in->tile_index;
+    out[1] = in->length;
+    memset(out + 2, 0, 1);
+    out[3] = in->x;
+    out[4] = in->y;
+    out[5] = in->width;
+    lifx_write_u32(out + 6, in->duration);
+    for (int i = 0; i < 64; i++)
+        lifx_encode_hsbk(out + 10 + i * 8, &in->colors[i]);
+}
+
+// GetTileEffect (718)
+#define LIFX_GET_TILE_EFFECT_SIZE 2
+
+// SetTileEffect (719)
+#define LIFX_SET_TILE_EFFECT_SIZE 188
+typedef struct _lifx_set_tile_effect_t
+{
+    lifx_tile_effect_settings_t settings;
+} lifx_set_tile_effect_t;
+
+static inline void lifx_decode_set_tile_effect(lifx_set_tile_effect_t *out, const uint8_t *in)
+{
+    lifx_decode_tile_effect_settings(&out->settings, in + 2);
+}
+
+static inline void lifx_encode_set_tile_effect(uint8_t *out, const lifx_set_tile_effect_t *in)
+{
+    memset(out, 0, 2);
+    lifx_encode_tile_effect_settings(out + 2, &in->settings);
+}
+
+// StateTileEffect (720)
+#define LIFX_STATE_TILE_EFFECT_SIZE 187
+typedef struct _lifx_state_tile_effect_t
+{
+    lifx_tile_effect_settings_t settings;
+} lifx_state_tile_effect_t;
+
+static inline void lifx_decode_state_tile_effect(lifx_state_tile_effect_t *out, const uint8_t *in)
+{
+    lifx_decode_tile_effect_settings(&out->settings, in + 1);
+}
+
+static inline void lifx_encode_state_tile_effect(uint8_t *out, const lifx_state_tile_effect_t *in)
+{
+    memset(out, 0, 1);
+    lifx_encode_tile_effect_settings(out + 1, &in->settings);
+}
+
+// -- END TILE MESSAGES --
+
+// -- START RELAY MESSAGES --
+
+// GetRPower (816)
+#define LIFX_GET_RPOWER_SIZE 1
+typedef struct _lifx_get_rpower_t
+{
+    uint8_t relay_index;
+} lifx_get_rpower_t;
+
+static inline void lifx_decode_get_rpower(lifx_get_rpower_t *out, const uint8_t *in)
+{
+    out->relay_index = in[0];
+}
+
+static inline void lifx_encode_get_rpower(uint8_t *out, const lifx_get_rpower_t *in)
+{
+    out[0] = in->relay_index;
+}
+
+// SetRPower (817)
+#define LIFX_SET_RPOWER_SIZE 3
+typedef struct _lifx_set_rpower_t
+{
+    uint8_t relay_index;
+    uint16_t level;
+} lifx_set_rpower_t;
+
+static inline void lifx_decode_set_rpower(lifx_set_rpower_t *out, const uint8_t *in)
+{
+    out->relay_index = in[0];
+    out->level = lifx_read_u16(in + 1);
+}
+
+static inline void lifx_encode_set_rpower(uint8_t *out, const lifx_set_rpower_t *in)
+{
+    out[0] = in->relay_index;
+    lifx_write_u16(out + 1, in->level);
+}
+
+// StateRPower (818)
+#define LIFX_STATE_RPOWER_SIZE 3
+typedef struct _lifx_state_rpower_t
+{
+    uint8_t relay_index;
+    uint16_t level;
+} lifx_state_rpower_t;
+
+static inline void lifx_decode_state_rpower(lifx_state_rpower_t *out, const uint8_t *in)
+{
+    out->relay_index = in[0];
+    out->level = lifx_read_u16(in + 1);
+}
+
+static inline void lifx_encode_state_rpower(uint8_t *out, const lifx_state_rpower_t *in)
+{
+    out[0] = in->relay_index;
+    lifx_write_u16(out + 1, in->level);
+}
+
+// -- END RELAY MESSAGES --
+
+#define LIFX_MESSAGE_MAX_TYPE 818
+
+// payload size of each message, every LIFX message has a fixed size
+static const uint16_t lifx_message_sizes[LIFX_MESSAGE_COUNT] = {
+    [LIFX_MSG_GET_SERVICE] = LIFX_GET_SERVICE_SIZE,
+    [LIFX_MSG_STATE_SERVICE] = LIFX_STATE_SERVICE_SIZE,
+    [LIFX_MSG_GET_HOST_FIRMWARE] = LIFX_GET_HOST_FIRMWARE_SIZE,
+    [LIFX_MSG_STATE_HOST_FIRMWARE] = LIFX_STATE_HOST_FIRMWARE_SIZE,
+    [LIFX_MSG_GET_WIFI_INFO] = LIFX_GET_WIFI_INFO_SIZE,
+    [LIFX_MSG_STATE_WIFI_INFO] = LIFX_STATE_WIFI_INFO_SIZE,
+    [LIFX_MSG_GET_WIFI_FIRMWARE] = LIFX_GET_WIFI_FIRMWARE_SIZE,
+    [LIFX_MSG_STATE_WIFI_FIRMWARE] = LIFX_STATE_WIFI_FIRMWARE_SIZE,
+    [LIFX_MSG_GET_POWER] = LIFX_GET_POWER_SIZE,
+    [LIFX_MSG_SET_POWER] = LIFX_SET_POWER_SIZE,
+    [LIFX_MSG_STATE_POWER] = LIFX_STATE_POWER_SIZE,
+    [LIFX_MSG_GET_LABEL] = LIFX_GET_LABEL_SIZE,
+    [LIFX_MSG_SET_LABEL] = LIFX_SET_LABEL_SIZE,
+    [LIFX_MSG_STATE_LABEL] = LIFX_STATE_LABEL_SIZE,
+    [LIFX_MSG_GET_VERSION] = LIFX_GET_VERSION_SIZE,
+    [LIFX_MSG_STATE_VERSION] = LIFX_STATE_VERSION_SIZE,
+    [LIFX_MSG_GET_INFO] = LIFX_GET_INFO_SIZE,
+    [LIFX_MSG_STATE_INFO] = LIFX_STATE_INFO_SIZE,
+    [LIFX_MSG_SET_REBOOT] = LIFX_SET_REBOOT_SIZE,
+    [LIFX_MSG_ACKNOWLEDGEMENT] = LIFX_ACKNOWLEDGEMENT_SIZE,
+    [LIFX_MSG_GET_LOCATION] = LIFX_GET_LOCATION_SIZE,
+    [LIFX_MSG_SET_LOCATION] = LIFX_SET_LOCATION_SIZE,
+    [LIFX_MSG_STATE_LOCATION] = LIFX_STATE_LOCATION_SIZE,
+    [LIFX_MSG_GET_GROUP] = LIFX_GET_GROUP_SIZE,
+    [LIFX_MSG_SET_GROUP] = LIFX_SET_GROUP_SIZE,
+    [LIFX_MSG_STATE_GROUP] = LIFX_STATE_GROUP_SIZE,
+    [LIFX_MSG_ECHO_REQUEST] = LIFX_ECHO_REQUEST_SIZE,
+    [LIFX_MSG_ECHO_RESPONSE] = LIFX_ECHO_RESPONSE_SIZE,
+    [LIFX_MSG_STATE_UNHANDLED] = LIFX_STATE_UNHANDLED_SIZE,
+    [LIFX_MSG_GET_COLOR] = LIFX_GET_COLOR_SIZE,
+    [LIFX_MSG_SET_COLOR] = LIFX_SET_COLOR_SIZE,
+    [LIFX_MSG_SET_WAVEFORM] = LIFX_SET_WAVEFORM_SIZE,
+    [LIFX_MSG_LIGHT_STATE] = LIFX_LIGHT_STATE_SIZE,
+    [LIFX_MSG_GET_LIGHT_POWER] = LIFX_GET_LIGHT_POWER_SIZE,
+    [LIFX_MSG_SET_LIGHT_POWER] = LIFX_SET_LIGHT_POWER_SIZE,
+    [LIFX_MSG_STATE_LIGHT_POWER] = LIFX_STATE_LIGHT_POWER_SIZE,
+    [LIFX_MSG_SET_WAVEFORM_OPTIONAL] = LIFX_SET_WAVEFORM_OPTIONAL_SIZE,
+    [LIFX_MSG_GET_INFRARED] = LIFX_GET_INFRARED_SIZE,
+    [LIFX_MSG_STATE_INFRARED] = LIFX_STATE_INFRARED_SIZE,
+    [LIFX_MSG_SET_INFRARED] = LIFX_SET_INFRARED_SIZE,
+    [LIFX_MSG_GET_HEV_CYCLE] = LIFX_GET_HEV_CYCLE_SIZE,
+    [LIFX_MSG_SET_HEV_CYCLE] = LIFX_SET_HEV_CYCLE_SIZE,
+    [LIFX_MSG_STATE_HEV_CYCLE] = LIFX_STATE_HEV_CYCLE_SIZE,
+    [LIFX_MSG_GET_HEV_CYCLE_CONFIGURATION] = LIFX_GET_HEV_CYCLE_CONFIGURATION_SIZE,
+    [LIFX_MSG_SET_HEV_CYCLE_CONFIGURATION] = LIFX_SET_HEV_CYCLE_CONFIGURATION_SIZE,
+    [LIFX_MSG_STATE_HEV_CYCLE_CONFIGURATION] = LIFX_STATE_HEV_CYCLE_CONFIGURATION_SIZE,
+    [LIFX_MSG_GET_LAST_HEV_CYCLE_RESULT] = LIFX_GET_LAST_HEV_CYCLE_RESULT_SIZE,
+    [LIFX_MSG_STATE_LAST_HEV_CYCLE_RESULT] = LIFX_STATE_LAST_HEV_CYCLE_RESULT_SIZE,
+    [LIFX_MSG_SENSOR_GET_AMBIENT_LIGHT] = LIFX_SENSOR_GET_AMBIENT_LIGHT_SIZE,
+    [LIFX_MSG_SENSOR_STATE_AMBIENT_LIGHT] = LIFX_SENSOR_STATE_AMBIENT_LIGHT_SIZE,
+    [LIFX_MSG_SET_COLOR_ZONES] = LIFX_SET_COLOR_ZONES_SIZE,
+    [LIFX_MSG_GET_COLOR_ZONES] = LIFX_GET_COLOR_ZONES_SIZE,
+    [LIFX_MSG_STATE_ZONE] = LIFX_STATE_ZONE_SIZE,
+    [LIFX_MSG_STATE_MULTI_ZONE] = LIFX_STATE_MULTI_ZONE_SIZE,
+    [LIFX_MSG_GET_MULTI_ZONE_EFFECT] = LIFX_GET_MULTI_ZONE_EFFECT_SIZE,
+    [LIFX_MSG_SET_MULTI_ZONE_EFFECT] = LIFX_SET_MULTI_ZONE_EFFECT_SIZE,
+    [LIFX_MSG_STATE_MULTI_ZONE_EFFECT] = LIFX_STATE_MULTI_ZONE_EFFECT_SIZE,
+    [LIFX_MSG_SET_EXTENDED_COLOR_ZONES] = LIFX_SET_EXTENDED_COLOR_ZONES_SIZE,
+    [LIFX_MSG_GET_EXTENDED_COLOR_ZONES] = LIFX_GET_EXTENDED_COLOR_ZONES_SIZE,
+    [LIFX_MSG_STATE_EXTENDED_COLOR_ZONES] = LIFX_STATE_EXTENDED_COLOR_ZONES_SIZE,
+    [LIFX_MSG_GET_DEVICE_CHAIN] = LIFX_GET_DEVICE_CHAIN_SIZE,
+    [LIFX_MSG_STATE_DEVICE_CHAIN] = LIFX_STATE_DEVICE_CHAIN_SIZE,
+    [LIFX_MSG_SET_USER_POSITION] = LIFX_SET_USER_POSITION_SIZE,
+    [LIFX_MSG_GET64] = LIFX_GET64_SIZE,
+    [LIFX_MSG_STATE64] = LIFX_STATE64_SIZE,
+    [LIFX_MSG_SET64] = LIFX_SET64_SIZE,
+    [LIFX_MSG_GET_TILE_EFFECT] = LIFX_GET_TILE_EFFECT_SIZE,
+    [LIFX_MSG_SET_TILE_EFFECT] = LIFX_SET_TILE_EFFECT_SIZE,
+    [LIFX_MSG_STATE_TILE_EFFECT] = LIFX_STATE_TILE_EFFECT_SIZE,
+    [LIFX_MSG_GET_RPOWER] = LIFX_GET_RPOWER_SIZE,
+    [LIFX_MSG_SET_RPOWER] = LIFX_SET_RPOWER_SIZE,
+    [LIFX_MSG_STATE_RPOWER] = LIFX_STATE_RPOWER_SIZE,
+};
+
+// maps a message type to its lifx_message_t, 0xFF for types that aren't known
+static const uint8_t lifx_message_index_table[LIFX_MESSAGE_MAX_TYPE + 1] = {
+    0xFF, 0xFF, // 0-1
+    LIFX_MSG_GET_SERVICE, // LIFX_PT_GETSERVICE
+    LIFX_MSG_STATE_SERVICE, // LIFX_PT_STATESERVICE
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 4-13
+    LIFX_MSG_GET_HOST_FIRMWARE, // LIFX_PT_GETHOSTFIRMWARE
+    LIFX_MSG_STATE_HOST_FIRMWARE, // LIFX_PT_STATEHOSTFIRMWARE
+    LIFX_MSG_GET_WIFI_INFO, // LIFX_PT_GETWIFIINFO
+    LIFX_MSG_STATE_WIFI_INFO, // LIFX_PT_STATEWIFIINFO
+    LIFX_MSG_GET_WIFI_FIRMWARE, // LIFX_PT_GETWIFIFIRMWARE
+    LIFX_MSG_STATE_WIFI_FIRMWARE, // LIFX_PT_STATEWIFIFIRMWARE
+    LIFX_MSG_GET_POWER, // LIFX_PT_GETPOWER
+    LIFX_MSG_SET_POWER, // LIFX_PT_SETPOWER
+    LIFX_MSG_STATE_POWER, // LIFX_PT_STATEPOWER
+    LIFX_MSG_GET_LABEL, // LIFX_PT_GETLABEL
+    LIFX_MSG_SET_LABEL, // LIFX_PT_SETLABEL
+    LIFX_MSG_STATE_LABEL, // LIFX_PT_STATELABEL
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 26-31
+    LIFX_MSG_GET_VERSION, // LIFX_PT_GETVERSION
+    LIFX_MSG_STATE_VERSION, // LIFX_PT_STATEVERSION
+    LIFX_MSG_GET_INFO, // LIFX_PT_GETINFO
+    LIFX_MSG_STATE_INFO, // LIFX_PT_STATEINFO
+    0xFF, 0xFF, // 36-37
+    LIFX_MSG_SET_REBOOT, // LIFX_PT_SETREBOOT
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 39-44
+    LIFX_MSG_ACKNOWLEDGEMENT, // LIFX_PT_ACKNOWLEDGEMENT
+    0xFF, 0xFF, // 46-47
+    LIFX_MSG_GET_LOCATION, // LIFX_PT_GETLOCATION
+    LIFX_MSG_SET_LOCATION, // LIFX_PT_SETLOCATION
+    LIFX_MSG_STATE_LOCATION, // LIFX_PT_STATELOCATION
+    LIFX_MSG_GET_GROUP, // LIFX_PT_GETGROUP
+    LIFX_MSG_SET_GROUP, // LIFX_PT_SETGROUP
+    LIFX_MSG_STATE_GROUP, // LIFX_PT_STATEGROUP
+    0xFF, 0xFF, 0xFF, 0xFF, // 54-57
+    LIFX_MSG_ECHO_REQUEST, // LIFX_PT_ECHOREQUEST
+    LIFX_MSG_ECHO_RESPONSE, // LIFX_PT_ECHORESPONSE
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 60-75
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 76-91
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 92-100
+    LIFX_MSG_GET_COLOR, // LIFX_PT_GETCOLOR
+    LIFX_MSG_SET_COLOR, // LIFX_PT_SETCOLOR
+    LIFX_MSG_SET_WAVEFORM, // LIFX_PT_SETWAVEFORM
+    0xFF, 0xFF, 0xFF, // 104-106
+    LIFX_MSG_LIGHT_STATE, // LIFX_PT_LIGHTSTATE
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 108-115
+    LIFX_MSG_GET_LIGHT_POWER, // LIFX_PT_GETLIGHTPOWER
+    LIFX_MSG_SET_LIGHT_POWER, // LIFX_PT_SETLIGHTPOWER
+    LIFX_MSG_STATE_LIGHT_POWER, // LIFX_PT_STATELIGHTPOWER
+    LIFX_MSG_SET_WAVEFORM_OPTIONAL, // LIFX_PT_SETWAVEFORMOPTIONAL
+    LIFX_MSG_GET_INFRARED, // LIFX_PT_GETINFRARED
+    LIFX_MSG_STATE_INFRARED, // LIFX_PT_STATEINFRARED
+    LIFX_MSG_SET_INFRARED, // LIFX_PT_SETINFRARED
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 123-138
+    0xFF, 0xFF, 0xFF, // 139-141
+    LIFX_MSG_GET_HEV_CYCLE, // LIFX_PT_GETHEVCYCLE
+    LIFX_MSG_SET_HEV_CYCLE, // LIFX_PT_SETHEVCYCLE
+    LIFX_MSG_STATE_HEV_CYCLE, // LIFX_PT_STATEHEVCYCLE
+    LIFX_MSG_GET_HEV_CYCLE_CONFIGURATION, // LIFX_PT_GETHEVCYCLECONFIGURATION
+    LIFX_MSG_SET_HEV_CYCLE_CONFIGURATION, // LIFX_PT_SETHEVCYCLECONFIGURATION
+    LIFX_MSG_STATE_HEV_CYCLE_CONFIGURATION, // LIFX_PT_STATEHEVCYCLECONFIGURATION
+    LIFX_MSG_GET_LAST_HEV_CYCLE_RESULT, // LIFX_PT_GETLASTHEVCYCLERESULT
+    LIFX_MSG_STATE_LAST_HEV_CYCLE_RESULT, // LIFX_PT_STATELASTHEVCYCLERESULT
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 150-165
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 166-181
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 182-197
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 198-213
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 214-222
+    LIFX_MSG_STATE_UNHANDLED, // LIFX_PT_STATEUNHANDLED
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 224-239
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 240-255
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 256-271
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 272-287
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 288-303
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 304-319
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 320-335
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 336-351
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 352-367
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 368-383
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 384-399
+    0xFF, // 400
+    LIFX_MSG_SENSOR_GET_AMBIENT_LIGHT, // LIFX_PT_SENSORGETAMBIENTLIGHT
+    LIFX_MSG_SENSOR_STATE_AMBIENT_LIGHT, // LIFX_PT_SENSORSTATEAMBIENTLIGHT
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 403-418
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 419-434
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 435-450
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 451-466
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 467-482
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 483-498
+    0xFF, 0xFF, // 499-500
+    LIFX_MSG_SET_COLOR_ZONES, // LIFX_PT_SETCOLORZONES
+    LIFX_MSG_GET_COLOR_ZONES, // LIFX_PT_GETCOLORZONES
+    LIFX_MSG_STATE_ZONE, // LIFX_PT_STATEZONE
+    0xFF, 0xFF, // 504-505
+    LIFX_MSG_STATE_MULTI_ZONE, // LIFX_PT_STATEMULTIZONE
+    LIFX_MSG_GET_MULTI_ZONE_EFFECT, // LIFX_PT_GETMULTIZONEEFFECT
+    LIFX_MSG_SET_MULTI_ZONE_EFFECT, // LIFX_PT_SETMULTIZONEEFFECT
+    LIFX_MSG_STATE_MULTI_ZONE_EFFECT, // LIFX_PT_STATEMULTIZONEEFFECT
+    LIFX_MSG_SET_EXTENDED_COLOR_ZONES, // LIFX_PT_SETEXTENDEDCOLORZONES
+    LIFX_MSG_GET_EXTENDED_COLOR_ZONES, // LIFX_PT_GETEXTENDEDCOLORZONES
+    LIFX_MSG_STATE_EXTENDED_COLOR_ZONES, // LIFX_PT_STATEEXTENDEDCOLORZONES
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 513-528
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 529-544
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 545-560
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 561-576
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 577-592
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 593-608
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 609-624
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 625-640
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 641-656
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 657-672
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 673-688
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 689-700
+    LIFX_MSG_GET_DEVICE_CHAIN, // LIFX_PT_GETDEVICECHAIN
+    LIFX_MSG_STATE_DEVICE_CHAIN, // LIFX_PT_STATEDEVICECHAIN
+    LIFX_MSG_SET_USER_POSITION, // LIFX_PT_SETUSERPOSITION
+    0xFF, 0xFF, 0xFF, // 704-706
+    LIFX_MSG_GET64, // LIFX_PT_GET64
+    0xFF, 0xFF, 0xFF, // 708-710
+    LIFX_MSG_STATE64, // LIFX_PT_STATE64
+    0xFF, 0xFF, 0xFF, // 712-714
+    LIFX_MSG_SET64, // LIFX_PT_SET64
+    0xFF, 0xFF, // 716-717
+    LIFX_MSG_GET_TILE_EFFECT, // LIFX_PT_GETTILEEFFECT
+    LIFX_MSG_SET_TILE_EFFECT, // LIFX_PT_SETTILEEFFECT
+    LIFX_MSG_STATE_TILE_EFFECT, // LIFX_PT_STATETILEEFFECT
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 721-736
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 737-752
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 753-768
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 769-784
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 785-800
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 801-815
+    LIFX_MSG_GET_RPOWER, // LIFX_PT_GETRPOWER
+    LIFX_MSG_SET_RPOWER, // LIFX_PT_SETRPOWER
+    LIFX_MSG_STATE_RPOWER, // LIFX_PT_STATERPOWER
+};
+
+static inline int lifx_message_index(uint16_t type)
+{
+    if (type > LIFX_MESSAGE_MAX_TYPE || lifx_message_index_table[type] == 0xFF)
+        return -1;
+    return lifx_message_index_table[type];
+}
+
+#endif // LIFX_MESSAGES_H_
@@ -1,15 +1,16 @@
 /*
     liblifx - lifx_protocol.h
-    Structure definitions for the LIFX network protocol and its packet types.
+    Structure definitions for the LIFX network protocol headers, and access to packet payloads.
 */
 
 #ifndef LIFX_PROTOCOL_H_
 #define LIFX_PROTOCOL_H_
 
-#include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include <assert.h>
+#include "lifx_internal.h"
 
 #ifndef static_assert // hack to silence compiler errors
 #define static_assert(...)
@@ -17,57 +18,6 @@
 
 #define PACKED __attribute__((packed))
 
-typedef enum _lifx_packet_type_t
-{
-    // System packet types
-    LIFX_PT_GETSERVICE = 2,
-    LIFX_PT_STATESERVICE = 3,
-    LIFX_PT_GETHOSTFIRMWARE = 14,
-    LIFX_PT_STATEHOSTFIRMWARE = 15,
-    LIFX_PT_GETWIFIINFO = 16,
-    LIFX_PT_STATEWIFIINFO = 17,
-    LIFX_PT_GETWIFIFIRMWARE = 18,
-    LIFX_PT_STATEWIFIFIRMWARE = 19,
-    LIFX_PT_GETPOWER = 20,
-    LIFX_PT_SETPOWER = 21,
-    LIFX_PT_STATEPOWER = 22,
-    LIFX_PT_GETLABEL = 23,
-    LIFX_PT_SETLABEL = 24,
-    LIFX_PT_STATELABEL = 25,
-    LIFX_PT_GETVERSION = 32,
-    LIFX_PT_STATEVERSION = 33,
-    LIFX_PT_GETINFO = 34,
-    LIFX_PT_STATEINFO = 35,
-    LIFX_PT_SETREBOOT = 38,
-    LIFX_PT_GETLOCATION = 48,
-    LIFX_PT_SETLOCATION = 49,
-    LIFX_PT_STATELOCATION = 50,
-    LIFX_PT_GETGROUP = 51,
-    LIFX_PT_SETGROUP = 52,
-    LIFT_PT_STATEGROUP = 53,
-    LIFX_PT_ECHOREQUEST = 58,
-    LIFX_PT_ECHORESPONSE = 59,
-    // Light packet types
-    LIFX_PT_GETCOLOR = 101,
-    LIFX_PT_SETCOLOR = 102,
-    LIFX_PT_SETWAVEFORM = 103,
-    LIFX_PT_LIGHTSTATE = 107,
-    LIFX_PT_GETLIGHTPOWER = 116,
-    LIFX_PT_SETLIGHTPOWER = 117,
-    LIFX_PT_STATELIGHTPOWER = 118,
-    LIFX_PT_SETWAVEFORMOPTIONAL = 119,
-    LIFX_PT_GETINFRARED = 120,
-    LIFX_PT_STATEINFRARED = 121,
-    LIFX_PT_SETINFRARED = 122,
-    LIFX_PT_GETHEVCYCLE = 142,
-    LIFX_PT_SETHEVCYCLE = 143,
-    LIFX_PT_STATEHEVCYCLE = 144,
-    LIFX_PT_SETHEVCYCLECONFIGURATION = 146,
-    LIFX_PT_STATEHEVCYCLECONFIGURATION = 147,
-    LIFX_PT_GETLASTHEVCYCLERESULT = 148,
-    LIFX_PT_STATELASTHEVCYCLERESULT = 149,
-} lifx_packet_type_t;
-
 typedef struct _lifx_frame_header_t
 {
     uint16_t size;
@@ -119,71 +69,87 @@ typedef struct _lifx_header_t
 } PACKED lifx_header_t;
 static_assert(sizeof(lifx_header_t) == 36, "packet header size");
 
-// -- START SYSTEM MESSAGES --
+// -- START FIELD ACCESS --
+// Payload fields are little endian and not necessarily aligned, these read and write them
+// through memcpy so the compiler can use plain loads and stores where the target allows it.
+
+#ifdef LIFX_BIG_ENDIAN
+#define LIFX_SWAP16(i) __builtin_bswap16(i)
+#define LIFX_SWAP32(i) __builtin_bswap32(i)
+#define LIFX_SWAP64(i) __builtin_bswap64(i)
+#else
+#define LIFX_SWAP16(i) (i)
+#define LIFX_SWAP32(i) (i)
+#define LIFX_SWAP64(i) (i)
+#endif
 
-typedef struct _lifx_state_service_t
+static inline uint16_t lifx_read_u16(const uint8_t *in)
 {
-    uint8_t service;
-    uint32_t port;
-} PACKED lifx_state_service_t;
+    uint16_t value;
+    memcpy(&value, in, sizeof(value));
+    return LIFX_SWAP16(value);
+}
 
-typedef struct _lifx_state_host_firmware_t
+static inline uint32_t lifx_read_u32(const uint8_t *in)
 {
-    uint64_t timestamp;
-    uint8_t reserved[8];
-    uint16_t version_minor;
-    uint16_t version_major;
-} PACKED lifx_state_host_firmware_t;
+    uint32_t value;
+    memcpy(&value, in, sizeof(value));
+    return LIFX_SWAP32(value);
+}
 
-typedef struct _lifx_state_version_t
+static inline uint64_t lifx_read_u64(const uint8_t *in)
 {
-    uint32_t vendor;
-    uint32_t product;
-    uint8_t reserved[4];
-} PACKED lifx_state_version_t;
+    uint64_t value;
+    memcpy(&value, in, sizeof(value));
+    return LIFX_SWAP64(value);
+}
 
-typedef struct _lifx_state_label_t
+static inline int16_t lifx_read_i16(const uint8_t *in)
 {
-    char label[32];
-} PACKED lifx_state_label_t;
+    return (int16_t)lifx_read_u16(in);
+}
 
-// -- END SYSTEM MESSAGES --
+static inline float lifx_read_f32(const uint8_t *in)
+{
+    uint32_t bits = lifx_read_u32(in);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
 
-// -- BEGIN LIGHT-SPECIFIC MESSAGES --
+static inline void lifx_write_u16(uint8_t *out, uint16_t value)
+{
+    value = LIFX_SWAP16(value);
+    memcpy(out, &value, sizeof(value));
+}
 
-typedef struct _lifx_light_state_t
+static inline void lifx_write_u32(uint8_t *out, uint32_t value)
 {
-    uint16_t hue;
-    uint16_t saturation;
-    uint16_t brightness;
-    uint16_t kelvin;
-    uint8_t reserved_1[2];
-    uint16_t power;
-    char label[32];
-    uint8_t reserved_2[8];
-} PACKED lifx_light_state_t;
-
-typedef struct _lifx_state_light_power_t
+    value = LIFX_SWAP32(value);
+    memcpy(out, &value, sizeof(value));
+}
+
+static inline void lifx_write_u64(uint8_t *out, uint64_t value)
 {
-    uint16_t level;
-} PACKED lifx_state_light_power_t;
+    value = LIFX_SWAP64(value);
+    memcpy(out, &value, sizeof(value));
+}
 
-typedef struct _lifx_set_color_t
+static inline void lifx_write_i16(uint8_t *out, int16_t value)
 {
-    uint8_t reserved;
-    uint16_t hue;
-    uint16_t saturation;
-    uint16_t brightness;
-    uint16_t kelvin;
-    uint32_t time_ms;
-} PACKED lifx_set_color_t;
-
-typedef struct _lifx_set_light_power_t
+    lifx_write_u16(out, (uint16_t)value);
+}
+
+static inline void lifx_write_f32(uint8_t *out, float value)
 {
-    uint16_t power;
-    uint32_t time_ms;
-} PACKED lifx_set_light_power_t;
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    lifx_write_u32(out, bits);
+}
+
+// -- END FIELD ACCESS --
 
-// -- END LIGHT-SPECIFIC MESSAGES --
+// message types, payloads and their codecs are generated from scripts/protocol.json
+#include "lifx_messages.h"
 
 #endif // LIFX_PROTOCOL_H_
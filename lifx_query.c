@@ -0,0 +1,256 @@
+/*
+    liblifx - lifx_query.c
+    A bitset of devices for each property, kept up to date as packets arrive, so queries over
+    the whole fleet are a few word-wide ANDs.
+*/
+
+#include <string.h>
+#include <lifx_config.h>
+#ifndef LIFX_NO_QUERY
+
+#include "lifx_internal.h"
+#include <lifx.h>
+
+typedef uint64_t lifx_bitset_word_t;
+#define LIFX_BITSET_WORD_BITS 64
+#define LIFX_BITSET_WORDS ((LIFX_MAX_DEVICE_COUNT + LIFX_BITSET_WORD_BITS - 1) / LIFX_BITSET_WORD_BITS)
+#define LIFX_NO_SECTION 0xFFFF
+// words in use for a table holding count devices, there's no need to look past them
+#define LIFX_BITSET_USED(count) (((count) + LIFX_BITSET_WORD_BITS - 1) / LIFX_BITSET_WORD_BITS)
+
+typedef struct _lifx_bitset_t
+{
+    lifx_bitset_word_t words[LIFX_BITSET_WORDS];
+} lifx_bitset_t;
+
+// devices sharing a group or location ID, a slot is free when it has no members
+typedef struct _lifx_section_index_t
+{
+    uint8_t uuid[16];
+    uint16_t count;
+    lifx_bitset_t members;
+} lifx_section_index_t;
+
+// there can't be more distinct sections than devices
+typedef struct _lifx_sections_t
+{
+    lifx_section_index_t slots[LIFX_MAX_DEVICE_COUNT];
+    uint16_t device_slot[LIFX_MAX_DEVICE_COUNT]; // slot each device is in, LIFX_NO_SECTION if none
+} lifx_sections_t;
+
+static lifx_bitset_t properties[LIFX_QUERY_PROPERTY_COUNT];
+static lifx_sections_t groups;
+static lifx_sections_t locations;
+
+static inline void lifx_bitset_set(lifx_bitset_t *bitset, int index, bool value)
+{
+    lifx_bitset_word_t bit = (lifx_bitset_word_t)1 << (index % LIFX_BITSET_WORD_BITS);
+    if (value)
+        bitset->words[index / LIFX_BITSET_WORD_BITS] |= bit;
+    else
+        bitset->words[index / LIFX_BITSET_WORD_BITS] &= ~bit;
+}
+
+static void lifx_reset_sections(lifx_sections_t *sections)
+{
+    memset(sections->slots, 0, sizeof(sections->slots));
+    for (int i = 0; i < LIFX_MAX_DEVICE_COUNT; i++)
+        sections->device_slot[i] = LIFX_NO_SECTION;
+}
+
+void lifx_reset_query()
+{
+    memset(properties, 0, sizeof(properties));
+    lifx_reset_sections(&groups);
+    lifx_reset_sections(&locations);
+}
+
+void lifx_query_set(lifx_device_t *device, uint8_t property, bool value)
+{
+    int index = device - lifx_get_devices();
+    // only a bit per property, which is cheap enough to do for every packet
+    for (int i = 0; i < LIFX_QUERY_PROPERTY_COUNT; i++) {
+        if (property & (1 << i))
+            lifx_bitset_set(&properties[i], index, value);
+    }
+}
+
+static int lifx_find_section(lifx_sections_t *sections, const uint8_t uuid[16])
+{
+    // new slots take the lowest free one, which is always below the device count
+    int count = lifx_get_device_count();
+    for (int i = 0; i < count; i++) {
+        if (sections->slots[i].count > 0 && memcmp(sections->slots[i].uuid, uuid, 16) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static void lifx_move_section(lifx_sections_t *sections, lifx_device_t *device, const uint8_t uuid[16])
+{
+    static const uint8_t no_uuid[16] = { 0 };
+    int index = device - lifx_get_devices();
+    uint16_t old_slot = sections->device_slot[index];
+    // devices report their section with every poll, it's only worth any work when it changes
+    if (old_slot != LIFX_NO_SECTION && memcmp(sections->slots[old_slot].uuid, uuid, 16) == 0)
+        return;
+    if (old_slot != LIFX_NO_SECTION) {
+        lifx_bitset_set(&sections->slots[old_slot].members, index, false);
+        sections->slots[old_slot].count--;
+        sections->device_slot[index] = LIFX_NO_SECTION;
+    }
+    // an all zero ID means the device isn't in one
+    if (memcmp(uuid, no_uuid, 16) == 0)
+        return;
+    int slot = lifx_find_section(sections, uuid);
+    if (slot < 0) {
+        // every other device is in at most one slot, so there's always a free one
+        for (slot = 0; sections->slots[slot].count > 0; slot++);
+        memcpy(sections->slots[slot].uuid, uuid, 16);
+    }
+    lifx_bitset_set(&sections->slots[slot].members, index, true);
+    sections->slots[slot].count++;
+    sections->device_slot[index] = slot;
+}
+
+void lifx_query_set_group(lifx_device_t *device, const uint8_t uuid[16])
+{
+    lifx_move_section(&groups, device, uuid);
+}
+
+void lifx_query_set_location(lifx_device_t *device, const uint8_t uuid[16])
+{
+    lifx_move_section(&locations, device, uuid);
+}
+
+// online is the only property that changes without a packet arriving, so it's caught up when it's asked about
+static void lifx_expire_online(uint32_t time_now)
+{
+    lifx_device_t *devices = lifx_get_devices();
+    lifx_bitset_t *online = &properties[__builtin_ctz(LIFX_QUERY_ONLINE)];
+    int words = LIFX_BITSET_USED(lifx_get_device_count());
+    for (int w = 0; w < words; w++) {
+        lifx_bitset_word_t word = online->words[w];
+        while (word != 0) {
+            int index = w * LIFX_BITSET_WORD_BITS + __builtin_ctzll(word);
+            word &= word - 1;
+            if (time_now - devices[index].last_update > LIFX_DEVICE_OFFLINE_MS) {
+                lifx_bitset_set(online, index, false);
+                LIFX_CHANGED(&devices[index]);
+            }
+        }
+    }
+}
+
+uint8_t lifx_query_get(lifx_device_t *device)
+{
+    int index = device - lifx_get_devices();
+    uint8_t bits = 0;
+    for (int i = 0; i < LIFX_QUERY_PROPERTY_COUNT; i++) {
+        if (properties[i].words[index / LIFX_BITSET_WORD_BITS] & ((lifx_bitset_word_t)1 << (index % LIFX_BITSET_WORD_BITS)))
+            bits |= 1 << i;
+    }
+    return bits;
+}
+
+// the bitsets a query reads, worked out once before going through the table
+typedef struct _lifx_query_plan_t
+{
+    uint8_t require;
+    uint8_t exclude;
+    const lifx_bitset_t *sections[2]; // group and location members, NULL for any
+    int count; // devices in the table
+} lifx_query_plan_t;
+
+// returns false if nothing can match
+static bool lifx_query_prepare(const lifx_query_t *query, lifx_query_plan_t *plan)
+{
+    memset(plan, 0, sizeof(lifx_query_plan_t));
+    plan->count = lifx_get_device_count();
+    if (query == NULL)
+        return true;
+    plan->require = query->require;
+    plan->exclude = query->exclude;
+    if (query->group != NULL) {
+        int slot = lifx_find_section(&groups, query->group);
+        if (slot < 0)
+            return false;
+        plan->sections[0] = &groups.slots[slot].members;
+    }
+    if (query->location != NULL) {
+        int slot = lifx_find_section(&locations, query->location);
+        if (slot < 0)
+            return false;
+        plan->sections[1] = &locations.slots[slot].members;
+    }
+    if ((query->require | query->exclude) & LIFX_QUERY_ONLINE)
+        lifx_expire_online(lifx_get_time_relative());
+    return true;
+}
+
+// starts from every device in the word, then narrows it down
+static inline lifx_bitset_word_t lifx_query_word(const lifx_query_plan_t *plan, int w)
+{
+    int first = w * LIFX_BITSET_WORD_BITS;
+    lifx_bitset_word_t word;
+    if (plan->count - first >= LIFX_BITSET_WORD_BITS)
+        word = ~(lifx_bitset_word_t)0;
+    else
+        word = ((lifx_bitset_word_t)1 << (plan->count - first)) - 1;
+    for (int i = 0; i < LIFX_QUERY_PROPERTY_COUNT; i++) {
+        if (plan->require & (1 << i))
+            word &= properties[i].words[w];
+        if (plan->exclude & (1 << i))
+            word &= ~properties[i].words[w];
+    }
+    for (int i = 0; i < 2; i++) {
+        if (plan->sections[i] != NULL)
+            word &= plan->sections[i]->words[w];
+    }
+    return word;
+}
+
+int lifx_query_devices(const lifx_query_t *query, lifx_device_t **results, int max_results)
+{
+    lifx_query_plan_t plan;
+    lifx_device_t *devices = lifx_get_devices();
+    int found = 0;
+    if (query == NULL)
+        return -1;
+    if (!lifx_query_prepare(query, &plan))
+        return 0;
+    for (int w = 0; w < LIFX_BITSET_USED(plan.count); w++) {
+        lifx_bitset_word_t word = lifx_query_word(&plan, w);
+        while (word != 0) {
+            int index = w * LIFX_BITSET_WORD_BITS + __builtin_ctzll(word);
+            word &= word - 1;
+            if (results != NULL && found < max_results)
+                results[found] = &devices[index];
+            found++;
+        }
+    }
+    return found;
+}
+
+int lifx_query_each(const lifx_query_t *query, lifx_query_visit_t visit, void *context)
+{
+    lifx_query_plan_t plan;
+    lifx_device_t *devices = lifx_get_devices();
+    int found = 0;
+    // the visitor may look at every device's properties, not just the ones being matched on
+    lifx_expire_online(lifx_get_time_relative());
+    if (!lifx_query_prepare(query, &plan))
+        return 0;
+    for (int w = 0; w < LIFX_BITSET_USED(plan.count); w++) {
+        lifx_bitset_word_t word = lifx_query_word(&plan, w);
+        while (word != 0) {
+            int index = w * LIFX_BITSET_WORD_BITS + __builtin_ctzll(word);
+            word &= word - 1;
+            if (visit(&devices[index], context))
+                found++;
+        }
+    }
+    return found;
+}
+
+#endif // LIFX_NO_QUERY
@@ -0,0 +1,101 @@
+/*
+    liblifx - lifx_queue.c
+    Packets waiting for a blocked transport, sent in order of priority once it can take them.
+*/
+
+#include <string.h>
+#include <lifx_config.h>
+#ifndef LIFX_NO_SEND_QUEUE
+
+#include "lifx_internal.h"
+#include <lifx.h>
+
+typedef struct _lifx_queued_packet_t
+{
+    uint32_t ipv4; // where the packet is going (in host order)
+    uint16_t port;
+    uint16_t length;
+    int8_t interface; // interface to send it out of, -1 for any
+    uint8_t data[LIFX_MAX_PACKET_SIZE]; // finished packet, header already flipped
+} lifx_queued_packet_t;
+
+// ring buffer of packets for one priority class
+typedef struct _lifx_queue_t
+{
+    lifx_queued_packet_t packets[LIFX_SEND_QUEUE_SIZE];
+    uint16_t head; // index of the oldest packet
+    uint16_t count;
+} lifx_queue_t;
+
+static lifx_queue_t queues[LIFX_PRIORITY_COUNT];
+static lifx_queue_stats_t queue_stats;
+
+void lifx_reset_queue()
+{
+    memset(queues, 0, sizeof(queues));
+    memset(&queue_stats, 0, sizeof(queue_stats));
+}
+
+static void lifx_queue_push(lifx_priority_t priority, uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port, int interface)
+{
+    lifx_queue_t *queue = &queues[priority];
+    // the newest packet is the one worth keeping, a colour or poll from earlier has probably been superseded
+    if (queue->count == LIFX_SEND_QUEUE_SIZE) {
+        queue->head = (queue->head + 1) % LIFX_SEND_QUEUE_SIZE;
+        queue->count--;
+        queue_stats.dropped[priority]++;
+    }
+    lifx_queued_packet_t *slot = &queue->packets[(queue->head + queue->count) % LIFX_SEND_QUEUE_SIZE];
+    slot->ipv4 = ipv4;
+    slot->port = port;
+    slot->length = length;
+    slot->interface = interface;
+    memcpy(slot->data, packet, length);
+    queue->count++;
+    queue_stats.queued[priority]++;
+    if (queue->count > queue_stats.peak[priority])
+        queue_stats.peak[priority] = queue->count;
+}
+
+void lifx_queue_send(lifx_priority_t priority, uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port, int interface)
+{
+    // the queue is only ever filled while the transport is blocked, so when it isn't there's nothing to wait behind
+    if (!queue_stats.blocked && lifx_transmit(packet, length, ipv4, port, interface) == 0)
+        return;
+    queue_stats.blocked = true;
+    lifx_queue_push(priority, packet, length, ipv4, port, interface);
+}
+
+void lifx_transport_writable()
+{
+    queue_stats.blocked = false;
+    for (int priority = 0; priority < LIFX_PRIORITY_COUNT; priority++) {
+        lifx_queue_t *queue = &queues[priority];
+        while (queue->count > 0) {
+            lifx_queued_packet_t *slot = &queue->packets[queue->head];
+            if (lifx_transmit(slot->data, slot->length, slot->ipv4, slot->port, slot->interface) != 0) {
+                queue_stats.blocked = true;
+                return;
+            }
+            queue->head = (queue->head + 1) % LIFX_SEND_QUEUE_SIZE;
+            queue->count--;
+        }
+    }
+}
+
+void lifx_retry_queue()
+{
+    if (queue_stats.blocked)
+        lifx_transport_writable();
+}
+
+void lifx_get_queue_stats(lifx_queue_stats_t *stats)
+{
+    if (stats == NULL)
+        return;
+    memcpy(stats, &queue_stats, sizeof(lifx_queue_stats_t));
+    for (int priority = 0; priority < LIFX_PRIORITY_COUNT; priority++)
+        stats->depth[priority] = queues[priority].count;
+}
+
+#endif // LIFX_NO_SEND_QUEUE
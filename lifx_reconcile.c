@@ -0,0 +1,259 @@
+/*
+    liblifx - lifx_reconcile.c
+    Keeping lights at a target state, resending it to the ones that report something else.
+*/
+
+#include <string.h>
+#include <lifx_config.h>
+#ifndef LIFX_NO_RECONCILE
+
+#include "lifx_internal.h"
+#include "lifx_protocol.h"
+#include <lifx.h>
+
+#define LIFX_RECONCILE_SETTLE_MS 250 // wait after a transition ends before asking the light where it got to
+#define LIFX_RECONCILE_BACKOFF_MS 1000 // wait before the second attempt, doubled for each one after
+#define LIFX_RECONCILE_INTERVAL (1000 / LIFX_RECONCILE_RATE) // milliseconds of the rate limit each packet uses
+#define LIFX_RECONCILE_BURST_MS 1000 // up to a second's worth of packets can go out at once
+
+static_assert(LIFX_RECONCILE_RATE > 0 && LIFX_RECONCILE_RATE <= 1000, "reconcile rate is between 1 and 1000 packets a second");
+
+// a light's target and how it's getting on, stored at the same index as the device
+typedef struct _lifx_reconcile_t
+{
+    lifx_target_t target;
+    uint8_t status; // lifx_convergence_t
+    uint8_t attempts; // sends since the light last converged
+    uint8_t diverged; // LIFX_TARGET_* parts the light last reported differently, all of the target if not known
+    bool polled; // a GetColor has gone out and its answer is being waited for
+    uint32_t next; // time of the next send or check, or when the poll gives up
+} lifx_reconcile_t;
+
+static lifx_reconcile_t reconciles[LIFX_MAX_DEVICE_COUNT];
+static int targets_count = 0;
+static int converged_count = 0;
+static uint32_t rate_time = 0; // when the packets already sent have used up the rate limit
+static int cursor = 0; // device the next run starts from, so a busy rate limit doesn't always favour the same ones
+
+void lifx_reset_reconcile()
+{
+    memset(reconciles, 0, sizeof(reconciles));
+    targets_count = 0;
+    converged_count = 0;
+    rate_time = lifx_get_time_relative();
+    cursor = 0;
+}
+
+static void lifx_reconcile_set_status(lifx_reconcile_t *reconcile, lifx_convergence_t status)
+{
+    if (reconcile->status == LIFX_CONVERGENCE_CONVERGED)
+        converged_count--;
+    if (status == LIFX_CONVERGENCE_CONVERGED)
+        converged_count++;
+    reconcile->status = status;
+}
+
+static uint32_t lifx_reconcile_backoff(uint8_t attempts)
+{
+    // the first attempt goes straight out
+    if (attempts == 0)
+        return 0;
+    if (attempts > 16 || (LIFX_RECONCILE_BACKOFF_MS << (attempts - 1)) > LIFX_RECONCILE_MAX_BACKOFF_MS)
+        return LIFX_RECONCILE_MAX_BACKOFF_MS;
+    return LIFX_RECONCILE_BACKOFF_MS << (attempts - 1);
+}
+
+// takes packets from the rate limit, returns false if there isn't room for them yet
+static bool lifx_reconcile_take(int packets, uint32_t time_now)
+{
+    uint32_t cost = packets * LIFX_RECONCILE_INTERVAL;
+    if (LIFX_BEFORE(rate_time, time_now))
+        rate_time = time_now;
+    if (rate_time + cost - time_now > LIFX_RECONCILE_BURST_MS)
+        return false;
+    rate_time += cost;
+    return true;
+}
+
+// the parts of the target the light's state differs from, out of the ones in reported
+static uint8_t lifx_reconcile_compare(lifx_device_t *device, const lifx_target_t *target, uint8_t reported)
+{
+    uint8_t diverged = 0;
+    if ((target->fields & reported & LIFX_TARGET_COLOR) && !lifx_color_matches(device, device->light, target->color))
+        diverged |= LIFX_TARGET_COLOR;
+    if ((target->fields & reported & LIFX_TARGET_POWER) && (device->power == 0xFFFF) != target->powered)
+        diverged |= LIFX_TARGET_POWER;
+    return diverged;
+}
+
+int lifx_set_target(lifx_device_t *device, const lifx_target_t *target)
+{
+    lifx_reconcile_t *reconcile;
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE) || !(device->flags & LIFX_DEVICE_IS_LIGHT))
+        return -1;
+    reconcile = &reconciles[device - lifx_get_devices()];
+    if (reconcile->status != LIFX_CONVERGENCE_NONE)
+        targets_count--;
+    lifx_reconcile_set_status(reconcile, LIFX_CONVERGENCE_NONE);
+    if (target == NULL || (target->fields & (LIFX_TARGET_COLOR | LIFX_TARGET_POWER)) == 0)
+        return 0;
+    targets_count++;
+    reconcile->target = *target;
+    reconcile->target.fields &= LIFX_TARGET_COLOR | LIFX_TARGET_POWER;
+    reconcile->attempts = 0;
+    reconcile->polled = false;
+    reconcile->next = lifx_get_time_relative();
+    // the cached colour can be a prediction, so a light that looks to be there already is only asked to make sure
+    if ((device->flags & LIFX_DEVICE_STATE_KNOWN) && !(device->flags & LIFX_DEVICE_PREDICTED)) {
+        reconcile->diverged = lifx_reconcile_compare(device, &reconcile->target, LIFX_TARGET_COLOR | LIFX_TARGET_POWER);
+        if (reconcile->diverged == 0) {
+            lifx_reconcile_set_status(reconcile, LIFX_CONVERGENCE_VERIFYING);
+            return 0;
+        }
+    } else {
+        reconcile->diverged = reconcile->target.fields;
+    }
+    lifx_reconcile_set_status(reconcile, LIFX_CONVERGENCE_SENDING);
+    return 0;
+}
+
+int lifx_get_convergence(lifx_device_t *device, lifx_convergence_info_t *info)
+{
+    lifx_reconcile_t *reconcile;
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE))
+        return -1;
+    if (info != NULL) {
+        reconcile = &reconciles[device - lifx_get_devices()];
+        info->status = reconcile->status;
+        info->attempts = reconcile->attempts;
+        info->next_ms = -1;
+        if (reconcile->status != LIFX_CONVERGENCE_NONE) {
+            int32_t next = (int32_t)(reconcile->next - lifx_get_time_relative());
+            info->next_ms = next > 0 ? next : 0;
+        }
+    }
+    return 0;
+}
+
+int lifx_get_diverged_count()
+{
+    return targets_count - converged_count;
+}
+
+void lifx_reconcile_reported(lifx_device_t *device, bool color_reported)
+{
+    lifx_reconcile_t *reconcile;
+    uint8_t reported = color_reported ? LIFX_TARGET_COLOR | LIFX_TARGET_POWER : LIFX_TARGET_POWER;
+    uint32_t time_now;
+    if (targets_count == 0)
+        return;
+    reconcile = &reconciles[device - lifx_get_devices()];
+    // replies to the target being sent can show the light from before or part way through the change
+    if (reconcile->status == LIFX_CONVERGENCE_NONE || (reconcile->status == LIFX_CONVERGENCE_VERIFYING && !reconcile->polled))
+        return;
+    time_now = lifx_get_time_relative();
+    uint8_t diverged = lifx_reconcile_compare(device, &reconcile->target, reported);
+    if (diverged != 0) {
+        // a light that's answering again is worth trying straight away, one that keeps changing back is backed off
+        reconcile->diverged = diverged;
+        if (reconcile->status == LIFX_CONVERGENCE_UNREACHABLE)
+            reconcile->next = time_now;
+        else if (reconcile->status != LIFX_CONVERGENCE_SENDING)
+            reconcile->next = time_now + lifx_reconcile_backoff(reconcile->attempts);
+        reconcile->polled = false;
+        lifx_reconcile_set_status(reconcile, LIFX_CONVERGENCE_SENDING);
+        return;
+    }
+    // a report of just the power doesn't say anything about the colour
+    if ((reconcile->target.fields & ~reported) != 0)
+        return;
+    reconcile->attempts = 0;
+    reconcile->diverged = 0;
+    reconcile->polled = false;
+    reconcile->next = time_now + LIFX_RECONCILE_CHECK_MS;
+    lifx_reconcile_set_status(reconcile, LIFX_CONVERGENCE_CONVERGED);
+}
+
+// moves a light on a step if there's room in the rate limit, returns false if there isn't
+static bool lifx_reconcile_step(lifx_device_t *device, lifx_reconcile_t *reconcile, uint32_t time_now)
+{
+    switch (reconcile->status) {
+        case LIFX_CONVERGENCE_SENDING:
+        case LIFX_CONVERGENCE_UNREACHABLE: {
+            uint8_t send = reconcile->diverged != 0 ? reconcile->diverged : reconcile->target.fields;
+            if (!lifx_reconcile_take(__builtin_popcount(send), time_now))
+                return false;
+            if (send & LIFX_TARGET_COLOR)
+                lifx_send_light_hsbk(device, reconcile->target.color, reconcile->target.duration_ms);
+            if (send & LIFX_TARGET_POWER)
+                lifx_send_light_power(device, reconcile->target.powered, reconcile->target.duration_ms);
+            if (reconcile->attempts < 0xFF)
+                reconcile->attempts++;
+            reconcile->polled = false;
+            reconcile->next = time_now + reconcile->target.duration_ms + LIFX_RECONCILE_SETTLE_MS;
+            lifx_reconcile_set_status(reconcile, LIFX_CONVERGENCE_VERIFYING);
+            return true;
+        }
+        case LIFX_CONVERGENCE_VERIFYING:
+        case LIFX_CONVERGENCE_CONVERGED:
+            if (reconcile->polled) {
+                // no answer to the poll, the light's state isn't known any more
+                reconcile->polled = false;
+                reconcile->diverged = reconcile->target.fields;
+                reconcile->next = time_now + lifx_reconcile_backoff(reconcile->attempts);
+                lifx_reconcile_set_status(reconcile, LIFX_CONVERGENCE_UNREACHABLE);
+                return true;
+            }
+            if (!lifx_reconcile_take(1, time_now))
+                return false;
+            // the light state has both the colour and the power
+            lifx_send_packet_priority(device, LIFX_PT_GETCOLOR, NULL, 0, LIFX_PRIORITY_BACKGROUND);
+            reconcile->polled = true;
+            reconcile->next = time_now + LIFX_REQUEST_TIMEOUT_MS;
+            return true;
+    }
+    return true;
+}
+
+void lifx_run_reconcile(uint32_t time_now)
+{
+    lifx_device_t *devices = lifx_get_devices();
+    int count = lifx_get_device_count();
+    if (targets_count == 0)
+        return;
+    for (int n = 0; n < count; n++) {
+        int i = (cursor + n) % count;
+        lifx_reconcile_t *reconcile = &reconciles[i];
+        if (reconcile->status == LIFX_CONVERGENCE_NONE || LIFX_BEFORE(time_now, reconcile->next))
+            continue;
+        if (!lifx_reconcile_step(&devices[i], reconcile, time_now)) {
+            // out of room, this light goes first next time
+            cursor = i;
+            return;
+        }
+    }
+}
+
+bool lifx_get_reconcile_deadline(uint32_t *deadline)
+{
+    int count = lifx_get_device_count();
+    bool found = false;
+    if (targets_count == 0)
+        return false;
+    for (int i = 0; i < count; i++) {
+        lifx_reconcile_t *reconcile = &reconciles[i];
+        if (reconcile->status == LIFX_CONVERGENCE_NONE)
+            continue;
+        if (!found || LIFX_BEFORE(reconcile->next, *deadline)) {
+            *deadline = reconcile->next;
+            found = true;
+        }
+    }
+    // anything due has to wait for room in the rate limit, enough for the biggest step
+    uint32_t room = rate_time + LIFX_RECONCILE_INTERVAL * 2 - LIFX_RECONCILE_BURST_MS;
+    if (found && LIFX_BEFORE(*deadline, room))
+        *deadline = room;
+    return found;
+}
+
+#endif // LIFX_NO_RECONCILE
@@ -0,0 +1,201 @@
+/*
+    liblifx - lifx_request.c
+    Asynchronous requests, matched to their replies by sequence number.
+*/
+
+#include <string.h>
+#include <lifx_config.h>
+#ifndef LIFX_NO_REQUESTS
+
+#include "lifx_internal.h"
+#include "lifx_protocol.h"
+#include <lifx.h>
+
+// Requests are stored at (sequence % LIFX_MAX_PENDING_REQUESTS), so a reply
+// is matched by a single lookup rather than a search through every request.
+static_assert((LIFX_MAX_PENDING_REQUESTS & (LIFX_MAX_PENDING_REQUESTS - 1)) == 0 && LIFX_MAX_PENDING_REQUESTS <= 256,
+    "pending request count is a power of two no bigger than the sequence space");
+
+typedef struct _lifx_request_slot_t
+{
+    lifx_device_t *device; // device the request was sent to, NULL when the slot is free
+    lifx_request_callback_t callback;
+    void *context;
+    uint32_t deadline; // time the request times out
+    uint32_t generation; // bumped each time the slot is used, so stale handles don't match
+    lifx_request_type_t type; // what was asked for
+    uint8_t sequence; // sequence number the request was sent with
+} lifx_request_slot_t;
+
+typedef struct _lifx_request_info_t
+{
+    uint16_t get_type;
+    uint16_t state_type;
+    uint16_t state_size;
+} lifx_request_info_t;
+
+static const lifx_request_info_t request_info[LIFX_REQUEST_TYPE_COUNT] = {
+    [LIFX_REQUEST_LIGHT_STATE] = { LIFX_PT_GETCOLOR, LIFX_PT_LIGHTSTATE, LIFX_LIGHT_STATE_SIZE },
+    [LIFX_REQUEST_LIGHT_POWER] = { LIFX_PT_GETLIGHTPOWER, LIFX_PT_STATELIGHTPOWER, LIFX_STATE_LIGHT_POWER_SIZE },
+    [LIFX_REQUEST_LABEL] = { LIFX_PT_GETLABEL, LIFX_PT_STATELABEL, LIFX_STATE_LABEL_SIZE },
+    [LIFX_REQUEST_VERSION] = { LIFX_PT_GETVERSION, LIFX_PT_STATEVERSION, LIFX_STATE_VERSION_SIZE },
+    [LIFX_REQUEST_HOST_FIRMWARE] = { LIFX_PT_GETHOSTFIRMWARE, LIFX_PT_STATEHOSTFIRMWARE, LIFX_STATE_HOST_FIRMWARE_SIZE },
+    [LIFX_REQUEST_WIFI_INFO] = { LIFX_PT_GETWIFIINFO, LIFX_PT_STATEWIFIINFO, LIFX_STATE_WIFI_INFO_SIZE },
+};
+
+static lifx_request_slot_t requests[LIFX_MAX_PENDING_REQUESTS];
+static int requests_pending = 0;
+
+void lifx_reset_requests()
+{
+    memset(requests, 0, sizeof(requests));
+    requests_pending = 0;
+}
+
+int lifx_get_pending_request_count()
+{
+    return requests_pending;
+}
+
+lifx_request_t lifx_request(lifx_device_t *device, lifx_request_type_t type, uint32_t timeout_ms, lifx_request_callback_t callback, void *context)
+{
+    lifx_request_slot_t *slot = NULL;
+    if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE) || type < 0 || type >= LIFX_REQUEST_TYPE_COUNT || callback == NULL)
+        return -1;
+    if ((type == LIFX_REQUEST_LIGHT_STATE || type == LIFX_REQUEST_LIGHT_POWER) && !(device->flags & LIFX_DEVICE_IS_LIGHT))
+        return -1;
+    // take sequence numbers from the shared counter until one has a free slot
+    for (int i = 0; i < LIFX_MAX_PENDING_REQUESTS; i++) {
+        uint8_t sequence = lifx_next_sequence();
+        if (requests[sequence % LIFX_MAX_PENDING_REQUESTS].device == NULL) {
+            slot = &requests[sequence % LIFX_MAX_PENDING_REQUESTS];
+            slot->sequence = sequence;
+            break;
+        }
+    }
+    if (slot == NULL)
+        return -1;
+    slot->device = device;
+    slot->callback = callback;
+    slot->context = context;
+    slot->type = type;
+    slot->generation = (slot->generation + 1) & 0x7FFFFF;
+    requests_pending++;
+    lifx_send_packet_sequence(device, request_info[type].get_type, NULL, 0, slot->sequence, LIFX_PRIORITY_INTERACTIVE);
+    slot->deadline = device->last_send + (timeout_ms != 0 ? timeout_ms : LIFX_REQUEST_TIMEOUT_MS);
+    return (slot->generation << 8) | slot->sequence;
+}
+
+int lifx_cancel_request(lifx_request_t request)
+{
+    lifx_request_slot_t *slot;
+    if (request < 0)
+        return -1;
+    slot = &requests[(request & 0xFF) % LIFX_MAX_PENDING_REQUESTS];
+    if (slot->device == NULL || slot->sequence != (request & 0xFF) || slot->generation != (uint32_t)request >> 8)
+        return -1;
+    slot->device = NULL;
+    requests_pending--;
+    return 0;
+}
+
+static void lifx_decode_response(lifx_response_t *response, uint16_t type, const uint8_t *payload)
+{
+    memset(response, 0, sizeof(lifx_response_t));
+    switch (type) {
+        case LIFX_PT_LIGHTSTATE: {
+            lifx_light_state_t light;
+            lifx_decode_light_state(&light, payload);
+            response->type = LIFX_REQUEST_LIGHT_STATE;
+            response->light = light.color;
+            response->power = light.power;
+            memcpy(response->label, light.label, 32);
+            break;
+        }
+        case LIFX_PT_STATELIGHTPOWER: {
+            lifx_state_light_power_t power;
+            lifx_decode_state_light_power(&power, payload);
+            response->type = LIFX_REQUEST_LIGHT_POWER;
+            response->power = power.level;
+            break;
+        }
+        case LIFX_PT_STATELABEL:
+            response->type = LIFX_REQUEST_LABEL;
+            memcpy(response->label, payload, LIFX_STATE_LABEL_SIZE);
+            break;
+        case LIFX_PT_STATEVERSION: {
+            lifx_state_version_t version;
+            lifx_decode_state_version(&version, payload);
+            response->type = LIFX_REQUEST_VERSION;
+            response->vendor = version.vendor;
+            response->product = version.product;
+            break;
+        }
+        case LIFX_PT_STATEHOSTFIRMWARE: {
+            lifx_state_host_firmware_t fw;
+            lifx_decode_state_host_firmware(&fw, payload);
+            response->type = LIFX_REQUEST_HOST_FIRMWARE;
+            response->firmware_build = fw.build;
+            response->firmware_major = fw.version_major;
+            response->firmware_minor = fw.version_minor;
+            break;
+        }
+        case LIFX_PT_STATEWIFIINFO: {
+            lifx_state_wifi_info_t wifi;
+            lifx_decode_state_wifi_info(&wifi, payload);
+            response->type = LIFX_REQUEST_WIFI_INFO;
+            response->signal = wifi.signal;
+            break;
+        }
+    }
+}
+
+void lifx_complete_request(uint8_t *packet, size_t length)
+{
+    lifx_header_t *header = (lifx_header_t *)packet;
+    lifx_request_slot_t *slot = &requests[header->address.sequence % LIFX_MAX_PENDING_REQUESTS];
+    lifx_response_t response;
+    if (requests_pending == 0 || slot->device == NULL)
+        return;
+    // the source has already been checked, make sure this is the reply we're waiting for from the device we asked
+    if (slot->sequence != header->address.sequence || request_info[slot->type].state_type != header->protocol.type ||
+        request_info[slot->type].state_size != length - sizeof(lifx_header_t) || memcmp(slot->device->mac, header->address.mac, 6) != 0)
+        return;
+    lifx_decode_response(&response, header->protocol.type, packet + sizeof(lifx_header_t));
+    // free the slot first so the callback can make another request
+    lifx_request_slot_t done = *slot;
+    slot->device = NULL;
+    requests_pending--;
+    done.callback((done.generation << 8) | done.sequence, done.device, LIFX_REQUEST_COMPLETE, &response, done.context);
+}
+
+bool lifx_get_request_deadline(uint32_t *deadline)
+{
+    bool found = false;
+    if (requests_pending == 0)
+        return false;
+    for (int i = 0; i < LIFX_MAX_PENDING_REQUESTS; i++) {
+        if (requests[i].device != NULL && (!found || LIFX_BEFORE(requests[i].deadline, *deadline))) {
+            *deadline = requests[i].deadline;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void lifx_expire_requests(uint32_t time_now)
+{
+    if (requests_pending == 0)
+        return;
+    for (int i = 0; i < LIFX_MAX_PENDING_REQUESTS; i++) {
+        lifx_request_slot_t *slot = &requests[i];
+        if (slot->device == NULL || LIFX_BEFORE(time_now, slot->deadline))
+            continue;
+        lifx_request_slot_t done = *slot;
+        slot->device = NULL;
+        requests_pending--;
+        done.callback((done.generation << 8) | done.sequence, done.device, LIFX_REQUEST_TIMEOUT, NULL, done.context);
+    }
+}
+
+#endif // LIFX_NO_REQUESTS
@@ -0,0 +1,242 @@
+/*
+    liblifx - lifx_scene.c
+    Scenes of light colours and power levels, applied by only sending what differs from each light's cached state.
+*/
+
+#include <string.h>
+#include <lifx_config.h>
+#ifndef LIFX_NO_SCENES
+
+#include "lifx_internal.h"
+#include "lifx_protocol.h"
+#include <lifx.h>
+
+#define LIFX_SCENE_COLOR (1 << 0)
+#define LIFX_SCENE_POWER (1 << 1)
+
+// commands are built on the stack and handed to the schedule this many at a time
+#define LIFX_SCENE_BATCH 16
+
+// a light waiting to confirm the scene applied to it, stored at the same index as the device
+typedef struct _lifx_scene_pending_t
+{
+    lifx_scene_callback_t callback; // NULL when the light isn't waiting on a scene
+    void *context;
+    lifx_hsbk_t color; // what the scene asked for, so a command left from an earlier scene isn't taken for this one
+    bool powered;
+    uint8_t needed; // LIFX_SCENE_* packets the scene needed
+    uint8_t sent; // LIFX_SCENE_* packets that have gone out
+    uint8_t waiting; // LIFX_SCENE_* packets that haven't been answered
+    uint8_t sequences[2]; // sequence numbers the colour and power went out with
+    uint32_t deadline; // time the last packet to go out times out
+} lifx_scene_pending_t;
+
+static lifx_scene_pending_t pending[LIFX_MAX_DEVICE_COUNT];
+static int pending_count = 0;
+
+void lifx_reset_scenes()
+{
+    memset(pending, 0, sizeof(pending));
+    pending_count = 0;
+}
+
+int lifx_get_pending_scene_count()
+{
+    return pending_count;
+}
+
+// where a light is heading, a transition we started is as good as finished
+static lifx_hsbk_t lifx_scene_target(lifx_device_t *device)
+{
+    if (device->flags & LIFX_DEVICE_PREDICTED)
+        return lifx_get_device_info(device)->transition_to;
+    return device->light;
+}
+
+static uint8_t lifx_scene_needed(const lifx_scene_entry_t *entry)
+{
+    lifx_device_t *device = entry->device;
+    uint8_t needed = 0;
+    // nothing is known about a light that hasn't reported its state since lifx_init, the cache doesn't keep colours
+    if (!(device->flags & LIFX_DEVICE_STATE_KNOWN))
+        return LIFX_SCENE_COLOR | LIFX_SCENE_POWER;
+    if (!lifx_color_matches(device, lifx_scene_target(device), entry->color))
+        needed |= LIFX_SCENE_COLOR;
+    if ((device->power == 0xFFFF) != entry->powered)
+        needed |= LIFX_SCENE_POWER;
+    return needed;
+}
+
+static void lifx_scene_finish(lifx_device_t *device, lifx_scene_pending_t *waiting, lifx_scene_result_t result)
+{
+    // cleared first so the callback can apply another scene
+    lifx_scene_pending_t done = *waiting;
+    memset(waiting, 0, sizeof(lifx_scene_pending_t));
+    pending_count--;
+    done.callback(device, result, done.context);
+}
+
+static void lifx_scene_sent(const lifx_command_t *command, uint8_t sequence)
+{
+    lifx_scene_pending_t *waiting = &pending[command->device - lifx_get_devices()];
+    int index = command->type == LIFX_COMMAND_COLOR ? 0 : 1;
+    if (waiting->callback == NULL || !(waiting->needed & (1 << index)) || (waiting->sent & (1 << index)))
+        return;
+    if (command->type == LIFX_COMMAND_COLOR ? memcmp(&command->color, &waiting->color, sizeof(lifx_hsbk_t)) != 0
+                                            : command->powered != waiting->powered)
+        return;
+    waiting->sent |= 1 << index;
+    waiting->sequences[index] = sequence;
+    waiting->deadline = command->device->last_send + LIFX_REQUEST_TIMEOUT_MS;
+}
+
+// what each of LIFX_SCENE_COLOR and LIFX_SCENE_POWER is answered with
+static const uint16_t scene_replies[2] = { LIFX_PT_LIGHTSTATE, LIFX_PT_STATELIGHTPOWER };
+
+void lifx_scene_received(lifx_device_t *device, uint8_t sequence, uint16_t type)
+{
+    lifx_scene_pending_t *waiting;
+    if (pending_count == 0)
+        return;
+    waiting = &pending[device - lifx_get_devices()];
+    if (waiting->callback == NULL)
+        return;
+    for (int i = 0; i < 2; i++) {
+        if ((waiting->sent & (1 << i)) && waiting->sequences[i] == sequence && scene_replies[i] == type)
+            waiting->waiting &= ~(1 << i);
+    }
+    if (waiting->waiting == 0)
+        lifx_scene_finish(device, waiting, LIFX_SCENE_CONFIRMED);
+}
+
+int lifx_save_scene(lifx_device_t **devices, int count, uint32_t duration_ms, lifx_scene_entry_t *scene)
+{
+    if (devices == NULL || scene == NULL || count < 0)
+        return -1;
+    for (int i = 0; i < count; i++) {
+        if (devices[i] == NULL || !(devices[i]->flags & LIFX_DEVICE_IN_USE) || !(devices[i]->flags & LIFX_DEVICE_IS_LIGHT))
+            return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        scene[i].device = devices[i];
+        scene[i].color = lifx_scene_target(devices[i]);
+        scene[i].powered = devices[i]->power == 0xFFFF;
+        scene[i].duration_ms = duration_ms;
+    }
+    return count;
+}
+
+// hands the commands waiting in the batch to the schedule, there's already known to be room for them
+static void lifx_scene_flush(lifx_command_t *batch, int *batch_count, uint32_t delay_ms, lifx_command_sent_t sent)
+{
+    if (*batch_count > 0)
+        lifx_schedule_commands(batch, *batch_count, delay_ms, sent);
+    *batch_count = 0;
+}
+
+int lifx_apply_scene(const lifx_scene_entry_t *scene, int count, uint32_t delay_ms, lifx_scene_callback_t callback, void *context)
+{
+    lifx_command_t batch[LIFX_SCENE_BATCH];
+    lifx_command_sent_t sent = callback != NULL ? lifx_scene_sent : NULL;
+    int batch_count = 0;
+    int commands = 0;
+    int changed = 0;
+    if (scene == NULL || count < 0)
+        return -1;
+    for (int i = 0; i < count; i++) {
+        lifx_device_t *device = scene[i].device;
+        if (device == NULL || !(device->flags & LIFX_DEVICE_IN_USE) || !(device->flags & LIFX_DEVICE_IS_LIGHT))
+            return -1;
+        commands += __builtin_popcount(lifx_scene_needed(&scene[i]));
+    }
+    // all or nothing like lifx_apply_synchronized, checked up front as the commands go in a batch at a time
+    if (commands > LIFX_MAX_SCHEDULED_COMMANDS - lifx_get_scheduled_count())
+        return -1;
+    // everything is worked out before anything is sent, sending a colour changes what the light is heading to
+    for (int i = 0; i < count; i++) {
+        lifx_device_t *device = scene[i].device;
+        lifx_scene_pending_t *waiting = &pending[device - lifx_get_devices()];
+        uint8_t needed = lifx_scene_needed(&scene[i]);
+        // anything an earlier scene still has to send would undo this one
+        lifx_schedule_cancel(device);
+        if (waiting->callback != NULL)
+            lifx_scene_finish(device, waiting, LIFX_SCENE_REPLACED);
+        if (needed == 0) {
+            if (callback != NULL)
+                callback(device, LIFX_SCENE_UNCHANGED, context);
+            continue;
+        }
+        changed++;
+        if (callback == NULL)
+            continue;
+        waiting->callback = callback;
+        waiting->context = context;
+        waiting->color = scene[i].color;
+        waiting->powered = scene[i].powered;
+        waiting->needed = needed;
+        waiting->waiting = needed;
+        pending_count++;
+    }
+    for (int i = 0; i < count; i++) {
+        lifx_device_t *device = scene[i].device;
+        if (!(lifx_scene_needed(&scene[i]) & LIFX_SCENE_COLOR))
+            continue;
+        lifx_command_t *command = &batch[batch_count++];
+        command->device = device;
+        command->type = LIFX_COMMAND_COLOR;
+        command->color = scene[i].color;
+        // a light that's off and being turned on takes its colour straight away, the power level does the fading
+        command->duration_ms = scene[i].powered && device->power == 0 ? 0 : scene[i].duration_ms;
+        if (batch_count == LIFX_SCENE_BATCH)
+            lifx_scene_flush(batch, &batch_count, delay_ms, sent);
+    }
+    lifx_scene_flush(batch, &batch_count, delay_ms, sent);
+    // a millisecond later, so each light has its colour before it's turned on
+    for (int i = 0; i < count; i++) {
+        if (!(lifx_scene_needed(&scene[i]) & LIFX_SCENE_POWER))
+            continue;
+        lifx_command_t *command = &batch[batch_count++];
+        command->device = scene[i].device;
+        command->type = LIFX_COMMAND_POWER;
+        command->powered = scene[i].powered;
+        command->duration_ms = scene[i].duration_ms;
+        if (batch_count == LIFX_SCENE_BATCH)
+            lifx_scene_flush(batch, &batch_count, delay_ms + 1, sent);
+    }
+    lifx_scene_flush(batch, &batch_count, delay_ms + 1, sent);
+    return changed;
+}
+
+void lifx_expire_scenes(uint32_t time_now)
+{
+    int count = lifx_get_device_count();
+    if (pending_count == 0)
+        return;
+    for (int i = 0; i < count; i++) {
+        lifx_scene_pending_t *waiting = &pending[i];
+        // the clock only starts once everything the light needed has gone out
+        if (waiting->callback == NULL || waiting->sent != waiting->needed || LIFX_BEFORE(time_now, waiting->deadline))
+            continue;
+        lifx_scene_finish(&lifx_get_devices()[i], waiting, LIFX_SCENE_TIMEOUT);
+    }
+}
+
+bool lifx_get_scene_deadline(uint32_t *deadline)
+{
+    int count = lifx_get_device_count();
+    bool found = false;
+    if (pending_count == 0)
+        return false;
+    for (int i = 0; i < count; i++) {
+        lifx_scene_pending_t *waiting = &pending[i];
+        if (waiting->callback == NULL || waiting->sent != waiting->needed)
+            continue;
+        if (!found || LIFX_BEFORE(waiting->deadline, *deadline)) {
+            *deadline = waiting->deadline;
+            found = true;
+        }
+    }
+    return found;
+}
+
+#endif // LIFX_NO_SCENES
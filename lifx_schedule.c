@@ -0,0 +1,153 @@
+/*
+    liblifx - lifx_schedule.c
+    Commands held back until a deadline, for changing many devices at the same moment.
+*/
+
+#include <string.h>
+#include <lifx_config.h>
+#ifndef LIFX_NO_SCHEDULE
+
+#include "lifx_internal.h"
+#include <lifx.h>
+
+typedef struct _lifx_scheduled_t
+{
+    uint32_t deadline; // time the command is sent
+    lifx_command_t command;
+    lifx_command_sent_t sent; // told the sequence number the command went out with, can be NULL
+} lifx_scheduled_t;
+
+// binary min-heap ordered by deadline, so the next command due is always at the top
+static lifx_scheduled_t schedule[LIFX_MAX_SCHEDULED_COMMANDS];
+static int schedule_count = 0;
+
+void lifx_reset_schedule()
+{
+    schedule_count = 0;
+}
+
+static void lifx_schedule_push(uint32_t deadline, const lifx_command_t *command, lifx_command_sent_t sent)
+{
+    int i = schedule_count++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!LIFX_BEFORE(deadline, schedule[parent].deadline))
+            break;
+        schedule[i] = schedule[parent];
+        i = parent;
+    }
+    schedule[i].deadline = deadline;
+    schedule[i].command = *command;
+    schedule[i].sent = sent;
+}
+
+// moves the command at i down until neither child is due before it
+static void lifx_schedule_sift_down(int i)
+{
+    lifx_scheduled_t moving = schedule[i];
+    while (true) {
+        int child = i * 2 + 1;
+        if (child >= schedule_count)
+            break;
+        if (child + 1 < schedule_count && LIFX_BEFORE(schedule[child + 1].deadline, schedule[child].deadline))
+            child++;
+        if (!LIFX_BEFORE(schedule[child].deadline, moving.deadline))
+            break;
+        schedule[i] = schedule[child];
+        i = child;
+    }
+    schedule[i] = moving;
+}
+
+static void lifx_schedule_pop(lifx_scheduled_t *out)
+{
+    *out = schedule[0];
+    if (--schedule_count > 0) {
+        schedule[0] = schedule[schedule_count];
+        lifx_schedule_sift_down(0);
+    }
+}
+
+void lifx_schedule_cancel(lifx_device_t *device)
+{
+    int kept = 0;
+    for (int i = 0; i < schedule_count; i++) {
+        if (schedule[i].command.device != device)
+            schedule[kept++] = schedule[i];
+    }
+    if (kept == schedule_count)
+        return;
+    // whatever's left is rebuilt into a heap from the bottom up
+    schedule_count = kept;
+    for (int i = schedule_count / 2 - 1; i >= 0; i--)
+        lifx_schedule_sift_down(i);
+}
+
+static void lifx_run_command(const lifx_scheduled_t *scheduled)
+{
+    const lifx_command_t *command = &scheduled->command;
+    int sequence = -1;
+    switch (command->type) {
+        case LIFX_COMMAND_COLOR:
+            sequence = lifx_send_light_hsbk(command->device, command->color, command->duration_ms);
+            break;
+        case LIFX_COMMAND_POWER:
+            sequence = lifx_send_light_power(command->device, command->powered, command->duration_ms);
+            break;
+    }
+    if (scheduled->sent != NULL && sequence >= 0)
+        scheduled->sent(command, sequence);
+}
+
+int lifx_apply_synchronized(const lifx_command_t *commands, int count, uint32_t delay_ms)
+{
+    return lifx_schedule_commands(commands, count, delay_ms, NULL);
+}
+
+int lifx_schedule_commands(const lifx_command_t *commands, int count, uint32_t delay_ms, lifx_command_sent_t sent)
+{
+    uint32_t activate;
+    if (commands == NULL || count < 0)
+        return -1;
+    // all or nothing, half a room changing on time isn't much use
+    if (count > LIFX_MAX_SCHEDULED_COMMANDS - schedule_count)
+        return -1;
+    for (int i = 0; i < count; i++) {
+        if (commands[i].device == NULL || !(commands[i].device->flags & LIFX_DEVICE_IN_USE))
+            return -1;
+    }
+    activate = lifx_get_time_relative() + delay_ms;
+    for (int i = 0; i < count; i++) {
+        // the recorded latency is a round trip, the command only has to make it one way
+        int32_t latency = commands[i].device->latency;
+        uint32_t one_way = latency > 0 ? latency / 2 : 0;
+        lifx_schedule_push(activate - one_way, &commands[i], sent);
+    }
+    // anything already due goes out now rather than waiting for the next tick
+    lifx_run_schedule(lifx_get_time_relative());
+    return count;
+}
+
+int lifx_get_scheduled_count()
+{
+    return schedule_count;
+}
+
+void lifx_run_schedule(uint32_t time_now)
+{
+    lifx_scheduled_t due;
+    while (schedule_count > 0 && !LIFX_BEFORE(time_now, schedule[0].deadline)) {
+        lifx_schedule_pop(&due);
+        lifx_run_command(&due);
+    }
+}
+
+bool lifx_get_schedule_deadline(uint32_t *deadline)
+{
+    if (schedule_count == 0)
+        return false;
+    *deadline = schedule[0].deadline;
+    return true;
+}
+
+#endif // LIFX_NO_SCHEDULE
@@ -0,0 +1,272 @@
+/*
+    liblifx - lifx_shm.c
+    The device table published to POSIX shared memory, so other processes on the host can read it without
+    doing their own discovery. Each record is guarded by a sequence lock, readers never block the publisher.
+*/
+
+#include <string.h>
+#include <lifx_config.h>
+#ifndef LIFX_NO_SHM
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "lifx_internal.h"
+#include <lifx.h>
+
+#define LIFX_SHM_MAGIC 0x5846494C // "LIFX"
+#define LIFX_SHM_VERSION 2
+#define LIFX_SHM_RETRIES 64 // attempts at reading a record before giving up on it, the publisher may have died mid-write
+
+typedef struct _lifx_shm_header_t
+{
+    atomic_uint magic; // written last, so a table that's still being set up isn't opened, and cleared when it's unpublished
+    uint16_t version;
+    uint16_t record_size; // sizeof(lifx_device_record_t), in case the two builds don't agree
+    uint32_t capacity; // records the table has room for
+    atomic_uint count; // records in use
+    atomic_uint generation; // publisher's generation when the table was last brought up to date
+    atomic_uint time_now; // publisher's time then, last_seen_ms is worked out from it, stored before any last_update
+    atomic_uint epoch; // bumped when the publisher calls lifx_init, generations start again from there
+} lifx_shm_header_t;
+
+// a record and the sequence lock guarding it, odd while it's being written
+typedef struct _lifx_shm_slot_t
+{
+    atomic_uint sequence;
+    atomic_uint last_update; // changes with every packet, so it's kept out of the record
+    lifx_device_record_t record;
+} __attribute__((aligned(64))) lifx_shm_slot_t;
+
+struct _lifx_shm_t
+{
+    lifx_shm_header_t *header;
+    lifx_shm_slot_t *slots;
+    size_t size;
+    uint32_t epoch; // the header's epoch when the table was opened
+};
+
+static_assert(sizeof(lifx_shm_header_t) <= sizeof(lifx_shm_slot_t), "the header fits in the first slot");
+
+#define LIFX_SHM_SIZE(capacity) (sizeof(lifx_shm_slot_t) + sizeof(lifx_shm_slot_t) * (capacity))
+
+static lifx_shm_t published = { 0 };
+static char published_name[64];
+static uint32_t published_generation = 0; // generation the table has been brought up to
+static uint32_t published_at = 0; // time the table was last brought up to date
+
+void lifx_reset_shm()
+{
+    // generations start again, so every record is out of date, and readers' since generations are meaningless
+    published_generation = 0;
+    if (published.header != NULL) {
+        atomic_fetch_add_explicit(&published.header->epoch, 1, memory_order_release);
+        atomic_store_explicit(&published.header->count, 0, memory_order_release);
+    }
+}
+
+int lifx_shm_publish(const char *name)
+{
+    size_t size = LIFX_SHM_SIZE(LIFX_MAX_DEVICE_COUNT);
+    int fd;
+    void *map;
+    if (name == NULL || strlen(name) >= sizeof(published_name))
+        return -1;
+    lifx_shm_unpublish();
+    // a new object rather than truncating an old one, readers with that mapped would fault on it shrinking
+    shm_unlink(name);
+    fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+        return -1;
+    if (ftruncate(fd, size) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        shm_unlink(name);
+        return -1;
+    }
+    // the header gets a slot to itself, so the records stay aligned
+    published.header = map;
+    published.slots = (lifx_shm_slot_t *)map + 1;
+    published.size = size;
+    strcpy(published_name, name);
+    published.header->version = LIFX_SHM_VERSION;
+    published.header->record_size = sizeof(lifx_device_record_t);
+    published.header->capacity = LIFX_MAX_DEVICE_COUNT;
+    atomic_store_explicit(&published.header->magic, LIFX_SHM_MAGIC, memory_order_release);
+    published_generation = 0;
+    lifx_run_shm(lifx_get_time_relative());
+    return 0;
+}
+
+void lifx_shm_unpublish()
+{
+    if (published.header == NULL)
+        return;
+    // readers still holding the table see it's closed rather than records that stop changing
+    atomic_store_explicit(&published.header->magic, 0, memory_order_release);
+    munmap(published.header, published.size);
+    shm_unlink(published_name);
+    memset(&published, 0, sizeof(published));
+}
+
+static bool lifx_shm_write_device(lifx_device_t *device, void *context)
+{
+    lifx_shm_slot_t *slot = &published.slots[device - lifx_get_devices()];
+    uint32_t time_now = *(uint32_t *)context;
+    lifx_device_record_t record;
+    atomic_store_explicit(&slot->last_update, device->last_update, memory_order_release);
+    if (!lifx_snapshot_changed_since(device, published_generation))
+        return false;
+    // filled in before taking the lock, so readers retry for as short a time as possible
+    lifx_snapshot_record(device, &record, time_now);
+    record.device = NULL;
+    uint32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+    atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&slot->record, &record, sizeof(record));
+    atomic_store_explicit(&slot->sequence, sequence + 2, memory_order_release);
+    return true;
+}
+
+void lifx_run_shm(uint32_t time_now)
+{
+    if (published.header == NULL)
+        return;
+    // nothing has changed, only the times and any transitions need bringing up to date now and again
+    if (lifx_get_generation() == published_generation && time_now - published_at < LIFX_SHM_INTERVAL_MS)
+        return;
+    // the time goes first, a reader that sees a new last_update then sees a time at least as new
+    atomic_store_explicit(&published.header->time_now, time_now, memory_order_release);
+    lifx_query_each(NULL, lifx_shm_write_device, &time_now);
+    // read afterwards, like lifx_snapshot_devices
+    published_generation = lifx_get_generation();
+    published_at = time_now;
+    atomic_store_explicit(&published.header->generation, published_generation, memory_order_relaxed);
+    atomic_store_explicit(&published.header->count, lifx_get_device_count(), memory_order_release);
+}
+
+bool lifx_get_shm_deadline(uint32_t *deadline)
+{
+    if (published.header == NULL)
+        return false;
+    *deadline = lifx_get_generation() != published_generation ? published_at : published_at + LIFX_SHM_INTERVAL_MS;
+    return true;
+}
+
+lifx_shm_t *lifx_shm_open(const char *name)
+{
+    lifx_shm_t *shm;
+    lifx_shm_header_t *header;
+    struct stat st;
+    void *map;
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return NULL;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < LIFX_SHM_SIZE(0)) {
+        close(fd);
+        return NULL;
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+    header = map;
+    if (atomic_load_explicit(&header->magic, memory_order_acquire) != LIFX_SHM_MAGIC || header->version != LIFX_SHM_VERSION ||
+        header->record_size != sizeof(lifx_device_record_t) || (size_t)st.st_size < LIFX_SHM_SIZE(header->capacity)) {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+    shm = malloc(sizeof(lifx_shm_t));
+    if (shm == NULL) {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+    shm->header = header;
+    shm->slots = (lifx_shm_slot_t *)map + 1;
+    shm->size = st.st_size;
+    shm->epoch = atomic_load_explicit(&header->epoch, memory_order_acquire);
+    return shm;
+}
+
+void lifx_shm_close(lifx_shm_t *shm)
+{
+    if (shm == NULL)
+        return;
+    munmap(shm->header, shm->size);
+    free(shm);
+}
+
+// the publisher has unpublished the table, or started again since it was opened
+static bool lifx_shm_closed(lifx_shm_t *shm)
+{
+    return atomic_load_explicit(&shm->header->magic, memory_order_acquire) != LIFX_SHM_MAGIC ||
+        atomic_load_explicit(&shm->header->epoch, memory_order_acquire) != shm->epoch;
+}
+
+uint32_t lifx_shm_get_generation(lifx_shm_t *shm)
+{
+    if (shm == NULL || lifx_shm_closed(shm))
+        return 0;
+    return atomic_load_explicit(&shm->header->generation, memory_order_acquire);
+}
+
+// copies a record out, returns false if it kept changing underneath
+static bool lifx_shm_read_slot(lifx_shm_slot_t *slot, lifx_device_record_t *record)
+{
+    for (int i = 0; i < LIFX_SHM_RETRIES; i++) {
+        uint32_t before = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (before & 1)
+            continue;
+        memcpy(record, (const void *)&slot->record, sizeof(lifx_device_record_t));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->sequence, memory_order_relaxed) == before)
+            return true;
+    }
+    return false;
+}
+
+int lifx_shm_read_devices(lifx_shm_t *shm, uint32_t since, lifx_device_record_t *records, int max_records, uint32_t *generation)
+{
+    lifx_device_record_t record;
+    uint32_t count, last_update;
+    int found = 0;
+    if (shm == NULL || lifx_shm_closed(shm))
+        return -1;
+    // the generation is read first, anything that changes while copying is picked up again next time
+    if (generation != NULL)
+        *generation = atomic_load_explicit(&shm->header->generation, memory_order_acquire);
+    count = atomic_load_explicit(&shm->header->count, memory_order_acquire);
+    if (count > shm->header->capacity)
+        count = shm->header->capacity;
+    for (uint32_t i = 0; i < count; i++) {
+        lifx_shm_slot_t *slot = &shm->slots[i];
+        if (!lifx_shm_read_slot(slot, &record))
+            continue;
+        if ((int32_t)(record.generation - since) <= 0 && !record.transition)
+            continue;
+        if (found < max_records && records != NULL) {
+            if (record.last_seen_ms != UINT32_MAX) {
+                // loaded in the opposite order to how they're stored, so the time is never older than the update
+                last_update = atomic_load_explicit(&slot->last_update, memory_order_acquire);
+                record.last_seen_ms = atomic_load_explicit(&shm->header->time_now, memory_order_acquire) - last_update;
+            }
+            records[found] = record;
+        }
+        found++;
+    }
+    // records rewritten after a restart have generations that can't be compared with since
+    if (lifx_shm_closed(shm))
+        return -1;
+    return found;
+}
+
+#endif // LIFX_NO_SHM
@@ -0,0 +1,93 @@
+/*
+    liblifx - lifx_snapshot.c
+    Copying the state of many devices out at once, optionally only the ones that have changed.
+*/
+
+#include <string.h>
+#include <lifx_config.h>
+#ifndef LIFX_NO_SNAPSHOT
+
+#include "lifx_internal.h"
+#include <lifx.h>
+
+static uint32_t generation = 0;
+static uint32_t device_generations[LIFX_MAX_DEVICE_COUNT]; // generation each device last changed in
+
+typedef struct _lifx_snapshot_t
+{
+    uint32_t since;
+    uint32_t time_now;
+    lifx_device_record_t *records;
+    int max_records;
+    int count;
+} lifx_snapshot_t;
+
+void lifx_reset_snapshot()
+{
+    generation = 0;
+    memset(device_generations, 0, sizeof(device_generations));
+}
+
+void lifx_snapshot_changed(lifx_device_t *device)
+{
+    device_generations[device - lifx_get_devices()] = ++generation;
+}
+
+uint32_t lifx_get_generation()
+{
+    return generation;
+}
+
+bool lifx_snapshot_changed_since(lifx_device_t *device, uint32_t since)
+{
+    // compared by subtracting so the counter can wrap, a moving colour is always worth sending
+    return (int32_t)(device_generations[device - lifx_get_devices()] - since) > 0 || (device->flags & LIFX_DEVICE_TRANSITION);
+}
+
+void lifx_snapshot_record(lifx_device_t *device, lifx_device_record_t *record, uint32_t time_now)
+{
+    lifx_device_info_t *info = lifx_get_device_info(device);
+    record->device = device;
+    // worked out first as a finished transition counts as a change
+    record->color = lifx_get_predicted_light(device);
+    record->transition = (device->flags & LIFX_DEVICE_TRANSITION) != 0;
+    record->generation = device_generations[device - lifx_get_devices()];
+    memcpy(record->mac, device->mac, 6);
+    record->port = device->port;
+    record->ipv4 = device->ipv4;
+    record->product = info->product;
+    record->latency = device->latency;
+    record->last_seen_ms = (device->flags & LIFX_DEVICE_SEEN) ? time_now - device->last_update : UINT32_MAX;
+    record->properties = lifx_query_get(device);
+    record->power = device->power;
+    record->firmware_major = info->version.major;
+    record->firmware_minor = info->version.minor;
+    memcpy(record->group, info->group.uuid, sizeof(record->group));
+    memcpy(record->location, info->location.uuid, sizeof(record->location));
+    memcpy(record->label, info->label, sizeof(info->label));
+    record->label[32] = 0;
+}
+
+static bool lifx_snapshot_device(lifx_device_t *device, void *context)
+{
+    lifx_snapshot_t *snapshot = context;
+    if (!lifx_snapshot_changed_since(device, snapshot->since))
+        return false;
+    if (snapshot->count++ < snapshot->max_records)
+        lifx_snapshot_record(device, &snapshot->records[snapshot->count - 1], snapshot->time_now);
+    return true;
+}
+
+int lifx_snapshot_devices(const lifx_query_t *query, uint32_t since, lifx_device_record_t *records, int max_records,
+    uint32_t *generation_out)
+{
+    lifx_snapshot_t snapshot = { .since = since, .time_now = lifx_get_time_relative(), .records = records,
+        .max_records = records != NULL ? max_records : 0 };
+    lifx_query_each(query, lifx_snapshot_device, &snapshot);
+    // read afterwards, so changes made while copying (transitions finishing) aren't reported again next time
+    if (generation_out != NULL)
+        *generation_out = generation;
+    return snapshot.count;
+}
+
+#endif // LIFX_NO_SNAPSHOT
@@ -0,0 +1,347 @@
+/*
+    liblifx - replay.c
+    Feeds the LIFX traffic in a pcap file through lifx_handle_incoming_packet.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../lifx_internal.h"
+#include "../lifx_protocol.h"
+#include <lifx.h>
+
+#define PCAP_MAGIC 0xA1B2C3D4
+#define PCAP_MAGIC_NS 0xA1B23C4D
+#define PCAP_LINKTYPE_ETHERNET 1
+#define PCAP_LINKTYPE_RAW 101
+#define PCAP_LINKTYPE_LINUX_SLL 113
+#define PCAP_LINKTYPE_IPV4 228
+
+typedef struct _replay_packet_t
+{
+    uint64_t time_us; // capture time, in microseconds
+    uint32_t src_ipv4; // in host order
+    uint16_t src_port;
+    bool outgoing; // sent by the client rather than a device
+    uint16_t length;
+    uint8_t *data;
+} replay_packet_t;
+
+static replay_packet_t *packets = NULL;
+static int packets_count = 0;
+static uint64_t packets_sent = 0;
+
+static void replay_send(uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port)
+{
+    // replies are already in the capture, just count what the library would have sent
+    packets_sent++;
+}
+
+static uint32_t replay_get32(const uint8_t *in, bool swap)
+{
+    uint32_t value;
+    memcpy(&value, in, 4);
+    return swap ? __builtin_bswap32(value) : value;
+}
+
+static uint16_t replay_get16_be(const uint8_t *in)
+{
+    return (in[0] << 8) | in[1];
+}
+
+static uint32_t replay_get32_be(const uint8_t *in)
+{
+    return ((uint32_t)replay_get16_be(in) << 16) | replay_get16_be(in + 2);
+}
+
+static uint64_t replay_virtual_time_us = 0;
+
+// when replaying as fast as possible, the library sees the capture's own timing
+static uint64_t replay_virtual_time_ms()
+{
+    return replay_virtual_time_us / 1000;
+}
+
+static uint64_t replay_time_us()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// packets the devices send, anything else must have come from a client
+static bool replay_is_device_message(uint16_t type)
+{
+    switch (type) {
+        case LIFX_PT_STATESERVICE:
+        case LIFX_PT_STATEHOSTFIRMWARE:
+        case LIFX_PT_STATEWIFIINFO:
+        case LIFX_PT_STATEWIFIFIRMWARE:
+        case LIFX_PT_STATEPOWER:
+        case LIFX_PT_STATELABEL:
+        case LIFX_PT_STATEVERSION:
+        case LIFX_PT_STATEINFO:
+        case LIFX_PT_ACKNOWLEDGEMENT:
+        case LIFX_PT_STATELOCATION:
+        case LIFX_PT_STATEGROUP:
+        case LIFX_PT_ECHORESPONSE:
+        case LIFX_PT_LIGHTSTATE:
+        case LIFX_PT_STATELIGHTPOWER:
+        case LIFX_PT_STATEINFRARED:
+        case LIFX_PT_STATEHEVCYCLE:
+        case LIFX_PT_STATEHEVCYCLECONFIGURATION:
+        case LIFX_PT_STATELASTHEVCYCLERESULT:
+            return true;
+    }
+    return false;
+}
+
+// strips the link layer, IPv4 and UDP headers, keeping anything that looks like LIFX traffic
+static void replay_add_frame(const uint8_t *frame, size_t length, uint32_t linktype, uint64_t time_us, uint32_t local_ipv4)
+{
+    size_t offset = 0;
+    uint16_t ethertype = 0x0800;
+    switch (linktype) {
+        case PCAP_LINKTYPE_ETHERNET:
+            if (length < 14)
+                return;
+            ethertype = replay_get16_be(frame + 12);
+            offset = 14;
+            // skip over any VLAN tags
+            while (ethertype == 0x8100 && length >= offset + 4) {
+                ethertype = replay_get16_be(frame + offset + 2);
+                offset += 4;
+            }
+            break;
+        case PCAP_LINKTYPE_LINUX_SLL:
+            if (length < 16)
+                return;
+            ethertype = replay_get16_be(frame + 14);
+            offset = 16;
+            break;
+        case PCAP_LINKTYPE_RAW:
+        case PCAP_LINKTYPE_IPV4:
+            break;
+        default:
+            return;
+    }
+    if (ethertype != 0x0800 || length < offset + 20)
+        return;
+    const uint8_t *ip = frame + offset;
+    size_t ip_header = (ip[0] & 0x0F) * 4;
+    if ((ip[0] >> 4) != 4 || ip[9] != 17 || length < offset + ip_header + 8)
+        return;
+    // fragmented datagrams aren't something LIFX devices send
+    if (replay_get16_be(ip + 6) & 0x3FFF)
+        return;
+    const uint8_t *udp = ip + ip_header;
+    size_t udp_length = replay_get16_be(udp + 4);
+    if (udp_length < 8 + sizeof(lifx_header_t) || length < offset + ip_header + udp_length)
+        return;
+    const uint8_t *payload = udp + 8;
+    size_t payload_length = udp_length - 8;
+    if (payload_length > LIFX_MAX_PACKET_SIZE)
+        return;
+    const lifx_header_t *header = (const lifx_header_t *)payload;
+    if (LE16(header->frame.size) != payload_length || header->frame.protocol != 1024)
+        return;
+
+    replay_packet_t *packet = &packets[packets_count++];
+    packet->time_us = time_us;
+    packet->src_ipv4 = replay_get32_be(ip + 12);
+    packet->src_port = replay_get16_be(udp);
+    if (local_ipv4 != 0)
+        packet->outgoing = packet->src_ipv4 == local_ipv4;
+    else
+        packet->outgoing = !replay_is_device_message(LE16(header->protocol.type));
+    packet->length = payload_length;
+    packet->data = (uint8_t *)payload;
+}
+
+static uint8_t *replay_load(const char *path, uint32_t local_ipv4)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        perror(path);
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    uint8_t *file = malloc(size);
+    if (file == NULL || size < 24 || fread(file, 1, size, fp) != size) {
+        fprintf(stderr, "%s: couldn't read file\n", path);
+        fclose(fp);
+        free(file);
+        return NULL;
+    }
+    fclose(fp);
+
+    uint32_t magic = replay_get32(file, false);
+    bool swap = magic == __builtin_bswap32(PCAP_MAGIC) || magic == __builtin_bswap32(PCAP_MAGIC_NS);
+    bool nanoseconds = magic == PCAP_MAGIC_NS || magic == __builtin_bswap32(PCAP_MAGIC_NS);
+    if (!swap && magic != PCAP_MAGIC && magic != PCAP_MAGIC_NS) {
+        fprintf(stderr, "%s: not a pcap file\n", path);
+        free(file);
+        return NULL;
+    }
+    uint32_t linktype = replay_get32(file + 20, swap);
+
+    // every record is at least 16 bytes, so that's the most packets there could be
+    packets = malloc(sizeof(replay_packet_t) * (size / 16));
+    if (packets == NULL) {
+        free(file);
+        return NULL;
+    }
+    long offset = 24;
+    while (offset + 16 <= size) {
+        uint64_t seconds = replay_get32(file + offset, swap);
+        uint64_t fraction = replay_get32(file + offset + 4, swap);
+        uint32_t incl_len = replay_get32(file + offset + 8, swap);
+        offset += 16;
+        if (incl_len > size - offset)
+            break;
+        uint64_t time_us = seconds * 1000000 + (nanoseconds ? fraction / 1000 : fraction);
+        replay_add_frame(file + offset, incl_len, linktype, time_us, local_ipv4);
+        offset += incl_len;
+    }
+    return file;
+}
+
+static void replay_print_devices()
+{
+    int count = lifx_get_device_count();
+    printf("\n%i devices in table:\n", count);
+    for (int i = 0; i < count; i++) {
+        lifx_device_t *device = lifx_get_device_from_num(i);
+        int product_id = lifx_get_device_product(device);
+        uint32_t ip = lifx_get_device_ipv4(device);
+        uint8_t *mac = lifx_get_device_mac(device);
+        printf("  %02x:%02x:%02x:%02x:%02x:%02x %i.%i.%i.%i %-24s fw %i.%i \"%s\"", mac[0], mac[1], mac[2], mac[3],
+            mac[4], mac[5], ip >> 24, (ip >> 16) & 0xFF, (ip >> 8) & 0xFF, ip & 0xFF, lifx_get_product_name(product_id),
+            lifx_get_device_firmware_major(device), lifx_get_device_firmware_minor(device), lifx_get_device_label(device));
+        if (lifx_product_is_light(product_id)) {
+            double hue, saturation, brightness;
+            short kelvin;
+            lifx_get_light_color(device, &hue, &saturation, &brightness, &kelvin);
+            printf(" %.0f %.0f%% %.0f%% %ik %s", hue, saturation * 100, brightness * 100, kelvin,
+                lifx_is_light_powered(device) ? "on" : "off");
+        }
+        printf("\n");
+    }
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-t] [-n loops] [-s source] [-l local ip] capture.pcap\n"
+                    "  -t  replay with the original timing instead of as fast as possible\n"
+                    "  -n  number of times to replay the capture\n"
+                    "  -s  source value to accept replies for, otherwise taken from the capture\n"
+                    "  -l  address the client was on, otherwise packets are sorted by message type\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    bool realtime = false;
+    int loops = 1;
+    bool have_source = false;
+    uint32_t source = 0;
+    uint32_t local_ipv4 = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "tn:s:l:h")) != -1) {
+        switch (opt) {
+            case 't': realtime = true; break;
+            case 'n': loops = atoi(optarg); break;
+            case 's': source = strtoul(optarg, NULL, 0); have_source = true; break;
+            case 'l': {
+                unsigned int a, b, c, d;
+                if (sscanf(optarg, "%u.%u.%u.%u", &a, &b, &c, &d) != 4) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                local_ipv4 = (a << 24) | (b << 16) | (c << 8) | d;
+                break;
+            }
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind >= argc || loops < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    uint8_t *file = replay_load(argv[optind], local_ipv4);
+    if (file == NULL)
+        return 1;
+
+    // the client's own packets tell us which source its replies were for
+    int incoming = 0;
+    for (int i = 0; i < packets_count; i++) {
+        if (!packets[i].outgoing) {
+            incoming++;
+        } else if (!have_source) {
+            source = ((lifx_header_t *)packets[i].data)->frame.source;
+            have_source = true;
+        }
+    }
+    printf("%i LIFX packets in capture, %i from devices\n", packets_count, incoming);
+    if (!have_source)
+        printf("no client packets found, only discovery replies will be accepted (use -s)\n");
+
+    if (!realtime) {
+        replay_virtual_time_us = packets_count > 0 ? packets[0].time_us : 0;
+        lifx_set_clock(replay_virtual_time_ms);
+    }
+    lifx_init(replay_send, NULL);
+    lifx_set_source(source);
+
+    uint8_t buffer[LIFX_MAX_PACKET_SIZE];
+    uint64_t fed = 0;
+    uint64_t start = replay_time_us();
+    for (int loop = 0; loop < loops; loop++) {
+        uint64_t loop_start = replay_time_us();
+        uint64_t loop_offset = replay_virtual_time_us - (packets_count > 0 ? packets[0].time_us : 0);
+        for (int i = 0; i < packets_count; i++) {
+            replay_packet_t *packet = &packets[i];
+            if (packet->outgoing)
+                continue;
+            if (!realtime) {
+                // each loop carries on from where the last one finished
+                replay_virtual_time_us = packet->time_us + loop_offset;
+            } else {
+                uint64_t due = loop_start + (packet->time_us - packets[0].time_us);
+                uint64_t time_now = replay_time_us();
+                if (due > time_now)
+                    usleep(due - time_now);
+            }
+            // the library may flip the header in place, so hand it a copy
+            memcpy(buffer, packet->data, packet->length);
+            lifx_handle_incoming_packet(buffer, packet->length, packet->src_ipv4, packet->src_port);
+            fed++;
+        }
+    }
+    uint64_t elapsed = replay_time_us() - start;
+
+    lifx_stats_t stats;
+    lifx_get_stats(&stats);
+    printf("replayed %llu packets in %.3fms, %.0f packets/sec\n", (unsigned long long)fed, elapsed / 1000.0,
+        elapsed > 0 ? fed * 1000000.0 / elapsed : 0);
+    printf("library sent %llu packets in response\n", (unsigned long long)packets_sent);
+    static const char *drop_names[LIFX_DROP_REASON_COUNT] = {
+        "size", "payload size", "source", "unknown device", "service", "table full", "unhandled"
+    };
+    for (int i = 0; i < LIFX_DROP_REASON_COUNT; i++) {
+        if (stats.drops[i] > 0)
+            printf("  dropped (%s): %llu\n", drop_names[i], (unsigned long long)stats.drops[i]);
+    }
+    replay_print_devices();
+
+    free(packets);
+    free(file);
+    return 0;
+}
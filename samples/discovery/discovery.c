@@ -58,6 +58,8 @@ int main(int argv, char **argc)
 
     // initialise the lifx library
     lifx_init(send_packet, NULL);
+    // broadcast on every network we're connected to, not just the default one
+    lifx_scan_interfaces();
 
     // send out a device discovery packet
     lifx_discover_devices();
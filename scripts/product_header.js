@@ -12,7 +12,7 @@ for (var i = 0; i < productlist[0].products.length; i++) {
     var product = productlist[0].products[i];
     output += "    {\n";
     output += "        .id = " + product.pid + ",\n";
-    output += "        .product_name = \"" + product.name + "\",\n";
+    output += "        LIFX_PRODUCT_NAME(\"" + product.name + "\")\n";
     if (product.features.hev)
         output += "        .hev = true,\n";
     if (product.features.color)
@@ -32,8 +32,7 @@ for (var i = 0; i < productlist[0].products.length; i++) {
     if (product.features.extended_multizone)
         output += "        .extended_multizone = true,\n";
     if (product.features.temperature_range != null) {
-        output += "        .temp_min = " + product.features.temperature_range[0] + ",\n";
-        output += "        .temp_max = " + product.features.temperature_range[1] + ",\n";
+        output += "        LIFX_PRODUCT_TEMP(" + product.features.temperature_range[0] + ", " + product.features.temperature_range[1] + ")\n";
     }
     output += "    },\n";
 }
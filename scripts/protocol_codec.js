@@ -0,0 +1,211 @@
+/*
+    liblifx - protocol_codec.js
+    NodeJS script that creates lifx_messages.h, the message types, payload structures and their
+    encoders and decoders, from the message spec in protocol.json.
+*/
+
+var fs = require("fs");
+var path = require("path");
+var spec = JSON.parse(fs.readFileSync(path.join(__dirname, "protocol.json")));
+
+var scalars = {
+    u8: { ctype: "uint8_t", size: 1 },
+    u16: { ctype: "uint16_t", size: 2 },
+    u32: { ctype: "uint32_t", size: 4 },
+    u64: { ctype: "uint64_t", size: 8 },
+    i16: { ctype: "int16_t", size: 2 },
+    f32: { ctype: "float", size: 4 },
+    bool: { ctype: "bool", size: 1 },
+    char: { ctype: "char", size: 1 },
+    reserved: { ctype: null, size: 1 }
+};
+var structs = {};
+
+function snake(name) {
+    return name.replace(/([a-z0-9])([A-Z])/g, "$1_$2").toLowerCase();
+}
+
+function fieldSize(field) {
+    var count = field[2] || 1;
+    if (scalars[field[1]])
+        return scalars[field[1]].size * count;
+    return structs[field[1]].size * count;
+}
+
+function payloadSize(fields) {
+    var size = 0;
+    for (var i = 0; i < (fields || []).length; i++)
+        size += fieldSize(fields[i]);
+    return size;
+}
+
+function hasValues(fields) {
+    for (var i = 0; i < (fields || []).length; i++) {
+        if (fields[i][1] != "reserved")
+            return true;
+    }
+    return false;
+}
+
+function ctypeOf(type) {
+    return scalars[type] ? scalars[type].ctype : structs[type].ctype;
+}
+
+function structDefinition(cname, fields) {
+    var output = "typedef struct _" + cname + "\n{\n";
+    for (var i = 0; i < fields.length; i++) {
+        var field = fields[i];
+        if (field[1] == "reserved")
+            continue;
+        output += "    " + ctypeOf(field[1]) + " " + field[0] + (field[2] ? "[" + field[2] + "]" : "") + ";\n";
+    }
+    return output + "} " + cname + ";\n";
+}
+
+// reads or writes a single value at an offset into the buffer
+function codecStatement(type, value, buffer, offset, decode) {
+    var at = offset == "0" ? buffer : buffer + " + " + offset;
+    var byte = buffer + "[" + offset + "]";
+    if (structs[type])
+        return decode ? "lifx_decode_" + type + "(&" + value + ", " + at + ");" : "lifx_encode_" + type + "(" + at + ", &" + value + ");";
+    if (type == "u8" || type == "char")
+        return decode ? value + " = " + byte + ";" : byte + " = " + value + ";";
+    if (type == "bool")
+        return decode ? value + " = " + byte + " != 0;" : byte + " = " + value + ";";
+    return decode ? value + " = lifx_read_" + type + "(" + at + ");" : "lifx_write_" + type + "(" + at + ", " + value + ");";
+}
+
+function codecFunction(name, cname, fields, decode) {
+    var output = "static inline void lifx_" + (decode ? "decode_" : "encode_") + name + "(";
+    output += decode ? cname + " *out, const uint8_t *in)\n{\n" : "uint8_t *out, const " + cname + " *in)\n{\n";
+    var buffer = decode ? "in" : "out";
+    var value = decode ? "out->" : "in->";
+    var offset = 0;
+    for (var i = 0; i < fields.length; i++) {
+        var field = fields[i];
+        var at = offset == 0 ? buffer : buffer + " + " + offset;
+        var count = field[2] || 1;
+        var size = fieldSize(field);
+        if (field[1] == "reserved") {
+            if (!decode)
+                output += "    memset(" + at + ", 0, " + size + ");\n";
+        } else if (field[2] && (field[1] == "u8" || field[1] == "char")) {
+            output += decode ? "    memcpy(" + value + field[0] + ", " + at + ", " + size + ");\n"
+                : "    memcpy(" + at + ", " + value + field[0] + ", " + size + ");\n";
+        } else if (field[2]) {
+            var step = size / count;
+            output += "    for (int i = 0; i < " + count + "; i++)\n";
+            output += "        " + codecStatement(field[1], value + field[0] + "[i]", buffer, (offset ? offset + " + " : "") + "i * " + step, decode) + "\n";
+        } else {
+            output += "    " + codecStatement(field[1], value + field[0], buffer, String(offset), decode) + "\n";
+        }
+        offset += size;
+    }
+    return output + "}\n";
+}
+
+var output = "/*\n";
+output += "    liblifx - lifx_messages.h\n";
+output += "    Generated by scripts/protocol_codec.js from scripts/protocol.json, don't edit by hand.\n";
+output += "*/\n\n";
+output += "#ifndef LIFX_MESSAGES_H_\n#define LIFX_MESSAGES_H_\n\n";
+output += "// included from lifx_protocol.h, which provides the lifx_read_* and lifx_write_* functions\n\n";
+
+// message types
+var messages = [];
+output += "typedef enum _lifx_packet_type_t\n{\n";
+for (var g = 0; g < spec.groups.length; g++) {
+    var group = spec.groups[g];
+    output += "    // " + group.name + " packet types\n";
+    for (var m = 0; m < group.messages.length; m++) {
+        var message = group.messages[m];
+        output += "    LIFX_PT_" + message.name.toUpperCase() + " = " + message.type + ",\n";
+        messages.push(message);
+    }
+}
+output += "} lifx_packet_type_t;\n\n";
+
+// dense numbering of the messages, so tables don't need an entry for every possible type
+var maxType = 0;
+output += "typedef enum _lifx_message_t\n{\n";
+for (var m = 0; m < messages.length; m++) {
+    output += "    LIFX_MSG_" + snake(messages[m].name).toUpperCase() + ",\n";
+    if (messages[m].type > maxType)
+        maxType = messages[m].type;
+}
+output += "    LIFX_MESSAGE_COUNT\n} lifx_message_t;\n\n";
+
+// shared structures
+output += "// -- START SHARED STRUCTURES --\n\n";
+for (var s = 0; s < spec.structs.length; s++) {
+    var struct = spec.structs[s];
+    structs[struct.name] = { ctype: struct.ctype, size: payloadSize(struct.fields) };
+    output += "#define LIFX_" + struct.name.toUpperCase() + "_SIZE " + structs[struct.name].size + "\n";
+    if (!struct.external)
+        output += structDefinition(struct.ctype, struct.fields);
+    output += "\n" + codecFunction(struct.name, struct.ctype, struct.fields, true);
+    output += "\n" + codecFunction(struct.name, struct.ctype, struct.fields, false) + "\n";
+}
+output += "// -- END SHARED STRUCTURES --\n\n";
+
+// message payloads
+for (var g = 0; g < spec.groups.length; g++) {
+    var group = spec.groups[g];
+    output += "// -- START " + group.name.toUpperCase() + " MESSAGES --\n\n";
+    for (var m = 0; m < group.messages.length; m++) {
+        var message = group.messages[m];
+        var name = snake(message.name);
+        var cname = "lifx_" + name + "_t";
+        message.size = payloadSize(message.fields);
+        output += "// " + message.name + " (" + message.type + ")\n";
+        output += "#define LIFX_" + name.toUpperCase() + "_SIZE " + message.size + "\n";
+        if (!hasValues(message.fields)) {
+            output += "\n";
+            continue;
+        }
+        output += structDefinition(cname, message.fields);
+        output += "\n" + codecFunction(name, cname, message.fields, true);
+        output += "\n" + codecFunction(name, cname, message.fields, false) + "\n";
+    }
+    output += "// -- END " + group.name.toUpperCase() + " MESSAGES --\n\n";
+}
+
+// lookup tables
+output += "#define LIFX_MESSAGE_MAX_TYPE " + maxType + "\n\n";
+output += "// payload size of each message, every LIFX message has a fixed size\n";
+output += "static const uint16_t lifx_message_sizes[LIFX_MESSAGE_COUNT] = {\n";
+for (var m = 0; m < messages.length; m++)
+    output += "    [LIFX_MSG_" + snake(messages[m].name).toUpperCase() + "] = LIFX_" + snake(messages[m].name).toUpperCase() + "_SIZE,\n";
+output += "};\n\n";
+output += "// maps a message type to its lifx_message_t, 0xFF for types that aren't known\n";
+output += "static const uint8_t lifx_message_index_table[LIFX_MESSAGE_MAX_TYPE + 1] = {\n";
+// every entry is written out, range designators and overriding initializers aren't portable C
+var byType = {};
+for (var m = 0; m < messages.length; m++)
+    byType[messages[m].type] = messages[m];
+var unknown = [];
+var flushUnknown = function (end) {
+    for (var i = 0; i < unknown.length; i += 16) {
+        var row = unknown.slice(i, i + 16);
+        output += "    " + row.map(function () { return "0xFF,"; }).join(" ") + " // " + row[0] +
+            (row.length > 1 ? "-" + row[row.length - 1] : "") + "\n";
+    }
+    unknown = [];
+};
+for (var t = 0; t <= maxType; t++) {
+    if (byType[t] === undefined) {
+        unknown.push(t);
+        continue;
+    }
+    flushUnknown();
+    output += "    LIFX_MSG_" + snake(byType[t].name).toUpperCase() + ", // LIFX_PT_" + byType[t].name.toUpperCase() + "\n";
+}
+flushUnknown();
+output += "};\n\n";
+output += "static inline int lifx_message_index(uint16_t type)\n{\n";
+output += "    if (type > LIFX_MESSAGE_MAX_TYPE || lifx_message_index_table[type] == 0xFF)\n";
+output += "        return -1;\n";
+output += "    return lifx_message_index_table[type];\n}\n\n";
+
+output += "#endif // LIFX_MESSAGES_H_\n";
+fs.writeFileSync(path.join(__dirname, "..", "lifx_messages.h"), output);
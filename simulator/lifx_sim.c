@@ -0,0 +1,543 @@
+/*
+    liblifx - lifx_sim.c
+    Emulates a fleet of LIFX devices on local UDP ports, for load testing the library.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "../lifx_internal.h"
+#include "../lifx_protocol.h"
+#include "../lifx_products.h"
+#include <lifx.h>
+#include "lifx_sim.h"
+
+#define LIFX_SIM_DEFAULT_PRODUCT 27 // LIFX Color
+#define LIFX_SIM_FIRMWARE_MAJOR 3
+#define LIFX_SIM_FIRMWARE_MINOR 70
+
+// Wi-Fi signals handed out to devices in turn, in mW: -50, -65, -75 and -85dBm
+static const float lifx_sim_signals[] = { 1e-5f, 3.2e-7f, 3.2e-8f, 3.2e-9f };
+
+// devices are spread across this many groups in turn, all in the one location
+#define LIFX_SIM_GROUP_COUNT 4
+#define LIFX_SIM_SECTION_UPDATED 1600000000000000000ULL
+
+typedef struct _lifx_sim_device_t
+{
+    int socket;
+    uint16_t port;
+    uint8_t mac[6];
+    uint32_t product;
+    char label[32];
+    uint16_t hue;
+    uint16_t saturation;
+    uint16_t brightness;
+    uint16_t kelvin;
+    uint16_t power;
+    float signal; // Wi-Fi signal in mW
+} lifx_sim_device_t;
+
+// like real firmware, a light keeps its kelvin within what it can show
+static uint16_t lifx_sim_kelvin(const lifx_sim_device_t *device, uint16_t kelvin)
+{
+    for (int i = 0; i < lifx_products_count; i++) {
+        if (lifx_products[i].id != (int)device->product || lifx_products[i].temp_min == 0)
+            continue;
+        if (kelvin < lifx_products[i].temp_min)
+            return lifx_products[i].temp_min;
+        if (kelvin > lifx_products[i].temp_max)
+            return lifx_products[i].temp_max;
+        break;
+    }
+    return kelvin;
+}
+
+typedef struct _lifx_sim_reply_t
+{
+    uint64_t due; // time the reply should be sent, in milliseconds
+    int device; // index of the device sending the reply
+    uint32_t ipv4; // where the reply is going (in host order)
+    uint16_t port;
+    uint16_t length;
+    uint8_t data[LIFX_MAX_PACKET_SIZE];
+} lifx_sim_reply_t;
+
+struct _lifx_sim_t
+{
+    lifx_sim_config_t config;
+    lifx_sim_device_t *devices;
+    int discovery_socket;
+    struct pollfd *fds; // discovery socket first, then one per device
+    // min-heap of replies waiting for their latency to pass
+    lifx_sim_reply_t *replies;
+    int replies_count;
+    int replies_capacity;
+    uint32_t random;
+    lifx_sim_stats_t stats;
+};
+
+static uint64_t lifx_sim_time_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+// xorshift32, good enough for latency and loss and reproducible from the seed
+static uint32_t lifx_sim_random(lifx_sim_t *sim)
+{
+    uint32_t x = sim->random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sim->random = x;
+    return x;
+}
+
+static bool lifx_sim_lose(lifx_sim_t *sim)
+{
+    if (sim->config.loss <= 0)
+        return false;
+    bool lost = (lifx_sim_random(sim) / (double)UINT32_MAX) < sim->config.loss;
+    if (lost)
+        sim->stats.packets_lost++;
+    return lost;
+}
+
+static int lifx_sim_create_socket(uint32_t ipv4, uint16_t port)
+{
+    struct sockaddr_in addr;
+    int one = 1;
+    int s = socket(AF_INET, SOCK_DGRAM, 0);
+    if (s < 0)
+        return -1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(s, SOL_SOCKET, SO_BROADCAST, &one, sizeof(one));
+    fcntl(s, F_SETFL, O_NONBLOCK);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(ipv4);
+    addr.sin_port = htons(port);
+    if (bind(s, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+static void lifx_sim_heap_swap(lifx_sim_t *sim, int a, int b)
+{
+    lifx_sim_reply_t temp = sim->replies[a];
+    sim->replies[a] = sim->replies[b];
+    sim->replies[b] = temp;
+}
+
+static lifx_sim_reply_t *lifx_sim_queue_reply(lifx_sim_t *sim, int device, uint32_t ipv4, uint16_t port)
+{
+    if (sim->replies_count == sim->replies_capacity) {
+        int capacity = sim->replies_capacity ? sim->replies_capacity * 2 : 64;
+        lifx_sim_reply_t *replies = realloc(sim->replies, capacity * sizeof(lifx_sim_reply_t));
+        if (replies == NULL)
+            return NULL;
+        sim->replies = replies;
+        sim->replies_capacity = capacity;
+    }
+    int delay = sim->config.latency_ms;
+    if (sim->config.jitter_ms > 0)
+        delay += (int)(lifx_sim_random(sim) % (sim->config.jitter_ms * 2 + 1)) - sim->config.jitter_ms;
+    if (delay < 0)
+        delay = 0;
+    lifx_sim_reply_t *reply = &sim->replies[sim->replies_count];
+    reply->due = lifx_sim_time_ms() + delay;
+    reply->device = device;
+    reply->ipv4 = ipv4;
+    reply->port = port;
+    reply->length = 0;
+    // the caller fills the packet in, sift it up the heap by its due time
+    int i = sim->replies_count++;
+    while (i > 0 && sim->replies[(i - 1) / 2].due > sim->replies[i].due) {
+        lifx_sim_heap_swap(sim, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    return &sim->replies[i];
+}
+
+static void lifx_sim_pop_reply(lifx_sim_t *sim)
+{
+    int i = 0;
+    sim->replies[0] = sim->replies[--sim->replies_count];
+    while (true) {
+        int smallest = i;
+        int left = i * 2 + 1;
+        int right = left + 1;
+        if (left < sim->replies_count && sim->replies[left].due < sim->replies[smallest].due)
+            smallest = left;
+        if (right < sim->replies_count && sim->replies[right].due < sim->replies[smallest].due)
+            smallest = right;
+        if (smallest == i)
+            break;
+        lifx_sim_heap_swap(sim, i, smallest);
+        i = smallest;
+    }
+}
+
+static void lifx_sim_reply(lifx_sim_t *sim, int num, lifx_header_t *request, uint32_t ipv4, uint16_t port, uint16_t type, void *payload, size_t size)
+{
+    lifx_sim_device_t *device = &sim->devices[num];
+    if (lifx_sim_lose(sim))
+        return;
+    lifx_sim_reply_t *reply = lifx_sim_queue_reply(sim, num, ipv4, port);
+    if (reply == NULL)
+        return;
+    lifx_header_t *header = (lifx_header_t *)reply->data;
+    memset(header, 0, sizeof(lifx_header_t));
+    header->frame.size = LE16(sizeof(lifx_header_t) + size);
+    header->frame.protocol = 1024;
+    header->frame.addressable = true;
+    header->frame.source = request->frame.source;
+    memcpy(header->address.mac, device->mac, 6);
+    header->address.sequence = request->address.sequence;
+    header->protocol.type = LE16(type);
+    if (payload != NULL && size > 0)
+        memcpy(reply->data + sizeof(lifx_header_t), payload, size);
+    reply->length = sizeof(lifx_header_t) + size;
+}
+
+static void lifx_sim_reply_light_state(lifx_sim_t *sim, int num, lifx_header_t *request, uint32_t ipv4, uint16_t port)
+{
+    lifx_sim_device_t *device = &sim->devices[num];
+    lifx_light_state_t light;
+    uint8_t payload[LIFX_LIGHT_STATE_SIZE];
+    light.color.hue = device->hue;
+    light.color.saturation = device->saturation;
+    light.color.brightness = device->brightness;
+    light.color.kelvin = device->kelvin;
+    light.power = device->power;
+    memcpy(light.label, device->label, sizeof(light.label));
+    lifx_encode_light_state(payload, &light);
+    lifx_sim_reply(sim, num, request, ipv4, port, LIFX_PT_LIGHTSTATE, payload, sizeof(payload));
+}
+
+static void lifx_sim_handle_packet(lifx_sim_t *sim, int num, uint8_t *packet, size_t length, uint32_t ipv4, uint16_t port)
+{
+    lifx_header_t *header = (lifx_header_t *)packet;
+    lifx_sim_device_t *device = &sim->devices[num];
+    uint8_t *payload = packet + sizeof(lifx_header_t);
+    size_t payload_size = length - sizeof(lifx_header_t);
+    uint16_t type = LE16(header->protocol.type);
+    bool res_required = header->address.res_required;
+
+    if (header->address.ack_required)
+        lifx_sim_reply(sim, num, header, ipv4, port, LIFX_PT_ACKNOWLEDGEMENT, NULL, 0);
+
+    switch (type) {
+        case LIFX_PT_GETSERVICE: {
+            lifx_state_service_t service;
+            uint8_t reply[LIFX_STATE_SERVICE_SIZE];
+            service.service = 1;
+            service.port = device->port;
+            lifx_encode_state_service(reply, &service);
+            lifx_sim_reply(sim, num, header, ipv4, port, LIFX_PT_STATESERVICE, reply, sizeof(reply));
+            return;
+        }
+        case LIFX_PT_GETVERSION: {
+            lifx_state_version_t version;
+            uint8_t reply[LIFX_STATE_VERSION_SIZE];
+            version.vendor = 1;
+            version.product = device->product;
+            lifx_encode_state_version(reply, &version);
+            lifx_sim_reply(sim, num, header, ipv4, port, LIFX_PT_STATEVERSION, reply, sizeof(reply));
+            return;
+        }
+        case LIFX_PT_GETHOSTFIRMWARE: {
+            lifx_state_host_firmware_t firmware;
+            uint8_t reply[LIFX_STATE_HOST_FIRMWARE_SIZE];
+            firmware.build = 1600000000000000000ULL;
+            firmware.version_major = LIFX_SIM_FIRMWARE_MAJOR;
+            firmware.version_minor = LIFX_SIM_FIRMWARE_MINOR;
+            lifx_encode_state_host_firmware(reply, &firmware);
+            lifx_sim_reply(sim, num, header, ipv4, port, LIFX_PT_STATEHOSTFIRMWARE, reply, sizeof(reply));
+            return;
+        }
+        case LIFX_PT_GETWIFIINFO: {
+            lifx_state_wifi_info_t wifi = { .signal = device->signal };
+            uint8_t reply[LIFX_STATE_WIFI_INFO_SIZE];
+            lifx_encode_state_wifi_info(reply, &wifi);
+            lifx_sim_reply(sim, num, header, ipv4, port, LIFX_PT_STATEWIFIINFO, reply, sizeof(reply));
+            return;
+        }
+        case LIFX_PT_GETLABEL: {
+            lifx_sim_reply(sim, num, header, ipv4, port, LIFX_PT_STATELABEL, device->label, LIFX_STATE_LABEL_SIZE);
+            return;
+        }
+        case LIFX_PT_GETGROUP: {
+            lifx_state_group_t group = { .updated_at = LIFX_SIM_SECTION_UPDATED };
+            uint8_t reply[LIFX_STATE_GROUP_SIZE];
+            memset(group.group, 0, sizeof(group.group));
+            memset(group.label, 0, sizeof(group.label));
+            memcpy(group.group, "simgroup", 8);
+            group.group[15] = num % LIFX_SIM_GROUP_COUNT + 1;
+            snprintf(group.label, sizeof(group.label), "Simulated Group %i", num % LIFX_SIM_GROUP_COUNT + 1);
+            lifx_encode_state_group(reply, &group);
+            lifx_sim_reply(sim, num, header, ipv4, port, LIFX_PT_STATEGROUP, reply, sizeof(reply));
+            return;
+        }
+        case LIFX_PT_GETLOCATION: {
+            lifx_state_location_t location = { .updated_at = LIFX_SIM_SECTION_UPDATED };
+            uint8_t reply[LIFX_STATE_LOCATION_SIZE];
+            memset(location.location, 0, sizeof(location.location));
+            memset(location.label, 0, sizeof(location.label));
+            memcpy(location.location, "simlocation", 11);
+            snprintf(location.label, sizeof(location.label), "Simulator");
+            lifx_encode_state_location(reply, &location);
+            lifx_sim_reply(sim, num, header, ipv4, port, LIFX_PT_STATELOCATION, reply, sizeof(reply));
+            return;
+        }
+        case LIFX_PT_ECHOREQUEST:
+            if (payload_size != LIFX_ECHO_REQUEST_SIZE)
+                break;
+            lifx_sim_reply(sim, num, header, ipv4, port, LIFX_PT_ECHORESPONSE, payload, payload_size);
+            return;
+        case LIFX_PT_GETCOLOR:
+            lifx_sim_reply_light_state(sim, num, header, ipv4, port);
+            return;
+        case LIFX_PT_SETCOLOR: {
+            if (payload_size != LIFX_SET_COLOR_SIZE)
+                break;
+            lifx_set_color_t color;
+            lifx_decode_set_color(&color, payload);
+            // like real firmware, the reply shows the light from before the change
+            if (res_required)
+                lifx_sim_reply_light_state(sim, num, header, ipv4, port);
+            device->hue = color.color.hue;
+            device->saturation = color.color.saturation;
+            device->brightness = color.color.brightness;
+            device->kelvin = lifx_sim_kelvin(device, color.color.kelvin);
+            return;
+        }
+        case LIFX_PT_SETWAVEFORM:
+        case LIFX_PT_SETWAVEFORMOPTIONAL: {
+            bool optional = type == LIFX_PT_SETWAVEFORMOPTIONAL;
+            if (payload_size != (optional ? LIFX_SET_WAVEFORM_OPTIONAL_SIZE : LIFX_SET_WAVEFORM_SIZE))
+                break;
+            // the optional message is the plain one with the flags on the end
+            lifx_set_waveform_optional_t waveform;
+            if (optional) {
+                lifx_decode_set_waveform_optional(&waveform, payload);
+            } else {
+                lifx_set_waveform_t plain;
+                lifx_decode_set_waveform(&plain, payload);
+                waveform.transient = plain.transient;
+                waveform.color = plain.color;
+            }
+            // effects aren't animated, non-transient ones just end on their colour
+            if (!waveform.transient) {
+                if (!optional || waveform.set_hue)
+                    device->hue = waveform.color.hue;
+                if (!optional || waveform.set_saturation)
+                    device->saturation = waveform.color.saturation;
+                if (!optional || waveform.set_brightness)
+                    device->brightness = waveform.color.brightness;
+                if (!optional || waveform.set_kelvin)
+                    device->kelvin = lifx_sim_kelvin(device, waveform.color.kelvin);
+            }
+            if (res_required)
+                lifx_sim_reply_light_state(sim, num, header, ipv4, port);
+            return;
+        }
+        case LIFX_PT_GETLIGHTPOWER:
+        case LIFX_PT_SETLIGHTPOWER: {
+            uint8_t reply[LIFX_STATE_LIGHT_POWER_SIZE];
+            lifx_set_light_power_t set_power;
+            if (type == LIFX_PT_SETLIGHTPOWER && payload_size != LIFX_SET_LIGHT_POWER_SIZE)
+                break;
+            // like real firmware, the reply has the level from before the change
+            lifx_write_u16(reply, device->power);
+            if (type == LIFX_PT_GETLIGHTPOWER || res_required)
+                lifx_sim_reply(sim, num, header, ipv4, port, LIFX_PT_STATELIGHTPOWER, reply, sizeof(reply));
+            if (type == LIFX_PT_SETLIGHTPOWER) {
+                lifx_decode_set_light_power(&set_power, payload);
+                device->power = set_power.level ? 0xFFFF : 0;
+            }
+            return;
+        }
+    }
+    sim->stats.packets_unhandled++;
+}
+
+static void lifx_sim_receive(lifx_sim_t *sim, int s, int num)
+{
+    uint8_t packet[LIFX_MAX_PACKET_SIZE];
+    struct sockaddr_in from;
+    socklen_t from_length = sizeof(from);
+    ssize_t r;
+    while ((r = recvfrom(s, packet, sizeof(packet), 0, (struct sockaddr *)&from, &from_length)) > 0) {
+        lifx_header_t *header = (lifx_header_t *)packet;
+        uint32_t ipv4 = ntohl(from.sin_addr.s_addr);
+        uint16_t port = ntohs(from.sin_port);
+        from_length = sizeof(from);
+        sim->stats.packets_in++;
+        if (r < sizeof(lifx_header_t) || LE16(header->frame.size) != r)
+            continue;
+        if (num < 0) {
+            // broadcasts on the discovery port go to every device, each one answering for itself
+            for (int i = 0; i < sim->config.device_count; i++) {
+                if (!lifx_sim_lose(sim))
+                    lifx_sim_handle_packet(sim, i, packet, r, ipv4, port);
+            }
+            continue;
+        }
+        // ignore anything addressed to a different device
+        static const uint8_t no_mac[6] = { 0 };
+        if (!header->frame.tagged && memcmp(header->address.mac, no_mac, 6) != 0 &&
+            memcmp(header->address.mac, sim->devices[num].mac, 6) != 0)
+            continue;
+        if (!lifx_sim_lose(sim))
+            lifx_sim_handle_packet(sim, num, packet, r, ipv4, port);
+    }
+}
+
+static void lifx_sim_send_due(lifx_sim_t *sim)
+{
+    uint64_t time_now = lifx_sim_time_ms();
+    while (sim->replies_count > 0 && sim->replies[0].due <= time_now) {
+        lifx_sim_reply_t *reply = &sim->replies[0];
+        struct sockaddr_in to;
+        memset(&to, 0, sizeof(to));
+        to.sin_family = AF_INET;
+        to.sin_addr.s_addr = htonl(reply->ipv4);
+        to.sin_port = htons(reply->port);
+        if (sendto(sim->devices[reply->device].socket, reply->data, reply->length, 0, (struct sockaddr *)&to, sizeof(to)) > 0)
+            sim->stats.packets_out++;
+        lifx_sim_pop_reply(sim);
+    }
+}
+
+lifx_sim_t *lifx_sim_create(const lifx_sim_config_t *config)
+{
+    if (config == NULL || config->device_count <= 0 || config->base_port == 0 ||
+        config->base_port + config->device_count > 0xFFFF)
+        return NULL;
+    lifx_sim_t *sim = calloc(1, sizeof(lifx_sim_t));
+    if (sim == NULL)
+        return NULL;
+    sim->config = *config;
+    if (sim->config.bind_ipv4 == 0)
+        sim->config.bind_ipv4 = 0x7F000001; // 127.0.0.1
+    if (sim->config.discovery_port == 0)
+        sim->config.discovery_port = LIFX_BROADCAST_PORT;
+    sim->random = config->seed ? config->seed : 0x4C494658; // 'LIFX'
+    sim->devices = calloc(config->device_count, sizeof(lifx_sim_device_t));
+    sim->fds = calloc(config->device_count + 1, sizeof(struct pollfd));
+    sim->discovery_socket = -1;
+    if (sim->devices == NULL || sim->fds == NULL)
+        goto fail;
+    for (int i = 0; i < config->device_count; i++)
+        sim->devices[i].socket = -1;
+
+    // broadcasts only arrive on sockets bound to any address
+    sim->discovery_socket = lifx_sim_create_socket(0, sim->config.discovery_port);
+    if (sim->discovery_socket < 0)
+        goto fail;
+    sim->fds[0].fd = sim->discovery_socket;
+    sim->fds[0].events = POLLIN;
+
+    for (int i = 0; i < config->device_count; i++) {
+        lifx_sim_device_t *device = &sim->devices[i];
+        device->port = config->base_port + i;
+        device->socket = lifx_sim_create_socket(sim->config.bind_ipv4, device->port);
+        if (device->socket < 0)
+            goto fail;
+        // d0:73:d5 is LIFX's prefix, the rest is the device number
+        device->mac[0] = 0xD0;
+        device->mac[1] = 0x73;
+        device->mac[2] = 0xD5;
+        device->mac[3] = (i >> 16) & 0xFF;
+        device->mac[4] = (i >> 8) & 0xFF;
+        device->mac[5] = i & 0xFF;
+        if (config->product_ids != NULL && config->product_count > 0)
+            device->product = config->product_ids[i % config->product_count];
+        else
+            device->product = LIFX_SIM_DEFAULT_PRODUCT;
+        snprintf(device->label, sizeof(device->label), "Simulated Light %i", i + 1);
+        device->signal = lifx_sim_signals[i % (sizeof(lifx_sim_signals) / sizeof(lifx_sim_signals[0]))];
+        device->hue = (i * 0x1000) & 0xFFFF;
+        device->saturation = 0xFFFF;
+        device->brightness = 0x8000;
+        device->kelvin = 3500;
+        device->power = 0xFFFF;
+        sim->fds[i + 1].fd = device->socket;
+        sim->fds[i + 1].events = POLLIN;
+    }
+    return sim;
+fail:
+    lifx_sim_destroy(sim);
+    return NULL;
+}
+
+void lifx_sim_destroy(lifx_sim_t *sim)
+{
+    if (sim == NULL)
+        return;
+    if (sim->discovery_socket >= 0)
+        close(sim->discovery_socket);
+    if (sim->devices != NULL) {
+        for (int i = 0; i < sim->config.device_count; i++) {
+            if (sim->devices[i].socket >= 0)
+                close(sim->devices[i].socket);
+        }
+    }
+    free(sim->devices);
+    free(sim->fds);
+    free(sim->replies);
+    free(sim);
+}
+
+int lifx_sim_run_once(lifx_sim_t *sim, int timeout_ms)
+{
+    // don't sleep past the next reply that's due
+    if (sim->replies_count > 0) {
+        uint64_t time_now = lifx_sim_time_ms();
+        int until_due = sim->replies[0].due > time_now ? sim->replies[0].due - time_now : 0;
+        if (timeout_ms < 0 || until_due < timeout_ms)
+            timeout_ms = until_due;
+    }
+    int ready = poll(sim->fds, sim->config.device_count + 1, timeout_ms);
+    if (ready < 0)
+        return -1;
+    for (int i = 0; i <= sim->config.device_count && ready > 0; i++) {
+        if (sim->fds[i].revents & POLLIN) {
+            lifx_sim_receive(sim, sim->fds[i].fd, i - 1);
+            ready--;
+        }
+    }
+    lifx_sim_send_due(sim);
+    return 0;
+}
+
+void lifx_sim_get_stats(lifx_sim_t *sim, lifx_sim_stats_t *stats)
+{
+    *stats = sim->stats;
+}
+
+uint16_t lifx_sim_get_device_port(lifx_sim_t *sim, int num)
+{
+    if (num < 0 || num >= sim->config.device_count)
+        return 0;
+    return sim->devices[num].port;
+}
+
+const uint8_t *lifx_sim_get_device_mac(lifx_sim_t *sim, int num)
+{
+    if (num < 0 || num >= sim->config.device_count)
+        return NULL;
+    return sim->devices[num].mac;
+}
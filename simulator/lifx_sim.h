@@ -0,0 +1,49 @@
+/*
+    liblifx - lifx_sim.h
+    Header for the virtual LIFX device fleet simulator.
+*/
+
+#ifndef LIFX_SIM_H_
+#define LIFX_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct _lifx_sim_t lifx_sim_t;
+
+typedef struct _lifx_sim_config_t
+{
+    int device_count; // number of virtual devices to run
+    uint32_t bind_ipv4; // address the devices listen on (in host order), 0 for 127.0.0.1
+    uint16_t base_port; // first device port, device n listens on base_port + n
+    uint16_t discovery_port; // port broadcast GetService packets are accepted on, 0 for 56700
+    const int *product_ids; // product IDs handed out to devices in turn, NULL for LIFX Color (27)
+    int product_count; // number of entries in product_ids
+    int latency_ms; // delay before every reply is sent
+    int jitter_ms; // random amount added to or taken away from the latency
+    double loss; // chance (0.0 - 1.0) of an incoming packet or reply being dropped
+    uint32_t seed; // seed for the latency and loss randomness
+} lifx_sim_config_t;
+
+typedef struct _lifx_sim_stats_t
+{
+    uint64_t packets_in;
+    uint64_t packets_out;
+    uint64_t packets_lost;
+    uint64_t packets_unhandled;
+} lifx_sim_stats_t;
+
+// Creates a simulated fleet and binds all of its sockets, returns NULL on failure.
+lifx_sim_t *lifx_sim_create(const lifx_sim_config_t *config);
+// Closes every socket and frees the simulator.
+void lifx_sim_destroy(lifx_sim_t *sim);
+// Handles incoming packets and sends due replies, waiting up to timeout_ms for something to happen.
+int lifx_sim_run_once(lifx_sim_t *sim, int timeout_ms);
+// Gets the counters for the simulator's traffic so far.
+void lifx_sim_get_stats(lifx_sim_t *sim, lifx_sim_stats_t *stats);
+// Gets the port a simulated device is listening on.
+uint16_t lifx_sim_get_device_port(lifx_sim_t *sim, int num);
+// Gets the MAC address of a simulated device.
+const uint8_t *lifx_sim_get_device_mac(lifx_sim_t *sim, int num);
+
+#endif // LIFX_SIM_H_
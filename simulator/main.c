@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include "lifx_sim.h"
+
+#define MAX_PRODUCTS 64
+
+static volatile sig_atomic_t running = 1;
+
+static void stop(int sig)
+{
+    running = 0;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-n devices] [-p base port] [-d discovery port] [-P product,product,...]\n"
+                    "          [-l latency ms] [-j jitter ms] [-x loss 0-1] [-s seed]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    int products[MAX_PRODUCTS];
+    lifx_sim_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.device_count = 16;
+    config.base_port = 56800;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:p:d:P:l:j:x:s:h")) != -1) {
+        switch (opt) {
+            case 'n': config.device_count = atoi(optarg); break;
+            case 'p': config.base_port = atoi(optarg); break;
+            case 'd': config.discovery_port = atoi(optarg); break;
+            case 'l': config.latency_ms = atoi(optarg); break;
+            case 'j': config.jitter_ms = atoi(optarg); break;
+            case 'x': config.loss = atof(optarg); break;
+            case 's': config.seed = strtoul(optarg, NULL, 0); break;
+            case 'P':
+                config.product_count = 0;
+                for (char *p = strtok(optarg, ","); p != NULL && config.product_count < MAX_PRODUCTS; p = strtok(NULL, ","))
+                    products[config.product_count++] = atoi(p);
+                config.product_ids = products;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    lifx_sim_t *sim = lifx_sim_create(&config);
+    if (sim == NULL) {
+        fprintf(stderr, "failed to create %i simulated devices on ports %i-%i\n", config.device_count,
+            config.base_port, config.base_port + config.device_count - 1);
+        return 1;
+    }
+    printf("Simulating %i devices on ports %i-%i\n", config.device_count, config.base_port,
+        config.base_port + config.device_count - 1);
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    // print the traffic counters every 5 seconds
+    time_t last_print = time(NULL);
+    while (running) {
+        lifx_sim_run_once(sim, 100);
+        if (time(NULL) - last_print >= 5) {
+            lifx_sim_stats_t stats;
+            lifx_sim_get_stats(sim, &stats);
+            printf("in: %llu out: %llu lost: %llu unhandled: %llu\n", (unsigned long long)stats.packets_in,
+                (unsigned long long)stats.packets_out, (unsigned long long)stats.packets_lost,
+                (unsigned long long)stats.packets_unhandled);
+            last_print = time(NULL);
+        }
+    }
+
+    lifx_sim_destroy(sim);
+    return 0;
+}